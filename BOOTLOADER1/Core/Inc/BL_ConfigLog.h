@@ -0,0 +1,49 @@
+/*
+ * BL_ConfigLog.h
+ *
+ * The boot config record log in the two config sectors.
+ * Shared between Bootloader and Application: the bootloader reaches the
+ * flash through Bootloader_Interface_t, an application passes its own
+ * erase and program routines. An application requests an update with
+ * BL_Config_Request(&flash, STATE_UPDATE_REQ) and then resets.
+ *
+ * Log format (see BL_ConfigRecord_t in bootloader_config.h):
+ * - 96-byte records, appended in order from the start of a sector.
+ *   seq counts up across both sectors; crc is the CRC-32 (IEEE 802.3)
+ *   of all bytes before it. The newest record with a good CRC is the
+ *   config; a torn record fails its CRC and the one before it counts.
+ * - When a sector is full, the other one is erased and takes the next
+ *   record, so the newest record is never erased.
+ * - A bare BootConfig_t at the start of the first sector, as
+ *   applications wrote it before the log existed, is taken over every
+ *   record. The next append erases it and continues the log there.
+ */
+
+#ifndef INC_BL_CONFIGLOG_H_
+#define INC_BL_CONFIGLOG_H_
+
+#include <stdint.h>
+#include "bootloader_config.h"
+
+/* The config sectors and the routines that change them (0 = success) */
+typedef struct {
+    uint32_t addr;          /* CONFIG_SECTOR_ADDR                     */
+    uint32_t alt_addr;      /* CONFIG_ALT_SECTOR_ADDR                 */
+    uint32_t size;          /* CONFIG_SECTOR_SIZE, of each sector     */
+    int    (*Erase)(uint32_t address, uint32_t length);
+    int    (*Write)(uint32_t address, const uint8_t *data, uint32_t length);
+} BL_ConfigFlash_t;
+
+/* Fills cfg; returns 1 if no config was found and cfg holds the defaults */
+uint8_t  BL_Config_Read(const BL_ConfigFlash_t *flash, BootConfig_t *cfg);
+
+/* Appends cfg unless it is already the newest; returns 1 on success */
+uint8_t  BL_Config_Append(const BL_ConfigFlash_t *flash, const BootConfig_t *cfg);
+
+/* Sequence number the next record will get */
+uint32_t BL_Config_Next_Seq(const BL_ConfigFlash_t *flash);
+
+/* Application side: sets system_status (STATE_UPDATE_REQ or STATE_ROLLBACK) */
+uint8_t  BL_Config_Request(const BL_ConfigFlash_t *flash, uint32_t state);
+
+#endif /* INC_BL_CONFIGLOG_H_ */
@@ -0,0 +1,34 @@
+/*
+ * BL_FlashWriter.h
+ *
+ * Coalescing write-back buffer in front of sys->Flash_Write.
+ * Collects sequential small writes (e.g. 16-byte AES blocks) and hands
+ * them to the driver in aligned chunks of BL_WRITE_BUF_SIZE bytes.
+ * Portable — uses only Bootloader_Interface_t. Initialised without an
+ * interface, it copies the chunks to RAM instead (RAM-staged installs).
+ */
+
+#ifndef INC_BL_FLASHWRITER_H_
+#define INC_BL_FLASHWRITER_H_
+
+#include <stdint.h>
+#include "system_interface.h"
+
+/* Chunk size handed to Flash_Write — a power of two */
+#ifndef BL_WRITE_BUF_SIZE
+#define BL_WRITE_BUF_SIZE  1024U
+#endif
+
+typedef struct {
+    const Bootloader_Interface_t *sys;  /* NULL: base is a RAM address    */
+    uint32_t base;       /* Flash address of buf[0]                     */
+    uint32_t fill;       /* Bytes currently buffered                    */
+    uint32_t fail_addr;  /* First address not programmed, 0 if no error */
+    uint8_t  buf[BL_WRITE_BUF_SIZE];
+} BL_FlashWriter_t;
+
+void BL_Writer_Init(BL_FlashWriter_t *w, const Bootloader_Interface_t *sys);
+int  BL_Writer_Put(BL_FlashWriter_t *w, uint32_t address, const uint8_t *data, uint32_t length);
+int  BL_Writer_Flush(BL_FlashWriter_t *w);
+
+#endif /* INC_BL_FLASHWRITER_H_ */
@@ -10,13 +10,24 @@
 
 #include "bootloader_config.h"
 #include "system_interface.h"
+#include "Cryptology_Control.h"
 
 void BL_SetInterface(const Bootloader_Interface_t *iface);
 
 uint8_t BL_ReadConfig(BootConfig_t *cfg);
 uint8_t BL_WriteConfig(BootConfig_t *cfg);
+uint8_t BL_Swap_Pending(const BootConfig_t *cfg);
 
-void BL_Swap_NoBuffer(void);
+/* footer_addr: package footer already found in S6, or 0 to look it up */
+void BL_Swap_NoBuffer(uint32_t footer_addr);
 uint8_t BL_Rollback(void);
 
+/*
+ * BL_XIP_AB: returns the slot to run in place and records it in the
+ * config. STATE_UPDATE_REQ switches to the other slot if it holds a newer
+ * valid image, STATE_ROLLBACK if it holds any valid image. With no usable
+ * slot recorded, the newer of the valid images is chosen. 0 if none.
+ */
+uint32_t BL_Xip_Select(BootConfig_t *cfg, uint32_t state);
+
 #endif /* INC_BL_FUNCTIONS_H_ */
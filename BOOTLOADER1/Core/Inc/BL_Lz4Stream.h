@@ -0,0 +1,37 @@
+/*
+ * BL_Lz4Stream.h
+ *
+ * Streaming decoder for LZ4-compressed update payloads (FW_FLAG_LZ4).
+ * Decrypted bytes are pushed in as they come out of the cipher; every
+ * complete block is decompressed in RAM and written to flash through a
+ * BL_FlashWriter_t. RAM use is bounded by FW_LZ4_BLOCK_SIZE.
+ */
+
+#ifndef INC_BL_LZ4STREAM_H_
+#define INC_BL_LZ4STREAM_H_
+
+#include <stdint.h>
+#include "BL_FlashWriter.h"
+#include "firmware_footer.h"
+#include "lz4.h"
+
+/* One record: 4-byte length + worst-case LZ4 block */
+#define BL_LZ4_RECORD_MAX  (4U + LZ4_COMPRESSBOUND(FW_LZ4_BLOCK_SIZE))
+
+typedef struct {
+    BL_FlashWriter_t *out;
+    uint32_t dest_addr;   /* Flash address of the first output byte      */
+    uint32_t produced;    /* Decompressed bytes written so far           */
+    uint32_t image_size;  /* Expected decompressed size                  */
+    uint32_t have;        /* Bytes of the current record in rec[]        */
+    uint8_t  error;
+    uint8_t  rec[BL_LZ4_RECORD_MAX];
+    uint8_t  block[FW_LZ4_BLOCK_SIZE];
+} BL_Lz4Stream_t;
+
+void BL_Lz4_Init(BL_Lz4Stream_t *z, BL_FlashWriter_t *out,
+                 uint32_t dest_addr, uint32_t image_size);
+int  BL_Lz4_Put(BL_Lz4Stream_t *z, const uint8_t *data, uint32_t length);
+int  BL_Lz4_Done(const BL_Lz4Stream_t *z);
+
+#endif /* INC_BL_LZ4STREAM_H_ */
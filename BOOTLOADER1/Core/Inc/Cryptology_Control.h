@@ -12,7 +12,27 @@
 #include "firmware_footer.h"
 #include "system_interface.h"
 
+/* Outcome of one check of a slot */
+typedef struct {
+    FW_Status_t status;      /* BL_OK if the signature matched            */
+    uint32_t    footer_addr; /* 0 if no footer was found                  */
+    fw_footer_t footer;      /* Copy of the footer that was checked       */
+    uint8_t     digest[32];  /* SHA-256 of the payload (of the manifest   */
+                             /* for AEAD/chunked packages), if has_digest */
+    uint8_t     has_digest;  /* 0 when no hash was computed (early error) */
+} FW_Verify_t;
+
 uint32_t Find_Footer_Address(uint32_t slot_start, uint32_t slot_size);
+const fw_header_t *Find_Header(uint32_t slot_start, uint32_t slot_size);
+FW_Status_t Firmware_Check_Header(uint32_t slot_start, uint32_t slot_size);
+uint32_t Firmware_Locate(uint32_t slot_start, uint32_t slot_size);
 FW_Status_t Firmware_Is_Valid(uint32_t start_addr, uint32_t size, const BL_CryptoOps_t *crypto);
+FW_Status_t Firmware_Verify(uint32_t start_addr, uint32_t slot_size, const BL_CryptoOps_t *crypto,
+                            FW_Verify_t *result);
+uint32_t Firmware_Manifest_Size(const fw_header_t *header, uint32_t payload_size);
+int Firmware_Manifest_Digest(uint32_t start_addr, const fw_footer_t *footer,
+                             const BL_CryptoOps_t *crypto, uint8_t digest[32]);
+FW_Status_t Firmware_Verify_Digest(const uint8_t digest[32], const fw_footer_t *footer,
+                                   const BL_CryptoOps_t *crypto);
 
 #endif /* INC_CRYPTOLOGY_CONTROL_H_ */
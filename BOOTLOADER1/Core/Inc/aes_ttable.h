@@ -0,0 +1,26 @@
+/*
+ * aes_ttable.h
+ *
+ * Word-oriented AES-128 (FIPS-197) using one 1 KB lookup table per
+ * direction. The other three round tables are byte rotations of the
+ * first, which the Cortex-M barrel shifter applies for free.
+ * Platform-independent — used by crypto_driver_sw.c when
+ * BL_AES_TTABLE is set.
+ */
+
+#ifndef INC_AES_TTABLE_H_
+#define INC_AES_TTABLE_H_
+
+#include <stdint.h>
+
+/* Expanded key: encryption round keys and equivalent-inverse-cipher keys */
+typedef struct {
+    uint32_t ek[44];
+    uint32_t dk[44];
+} AES_TT_Key_t;
+
+void AES_TT_SetKey(AES_TT_Key_t *key, const uint8_t raw[16]);
+void AES_TT_Encrypt(const AES_TT_Key_t *key, const uint8_t in[16], uint8_t out[16]);
+void AES_TT_Decrypt(const AES_TT_Key_t *key, const uint8_t in[16], uint8_t out[16]);
+
+#endif /* INC_AES_TTABLE_H_ */
@@ -6,6 +6,7 @@
  *
  * Portable bootloader configuration types.
  * Shared between Bootloader and Application — no hardware dependencies.
+ * Applications write the config through BL_ConfigLog.h, not directly.
  */
 
 #ifndef INC_BOOTLOADER_CONFIG_H_
@@ -16,6 +17,86 @@
 /* Magic number written to config sector to mark it as valid */
 #define CONFIG_MAGIC  0xDEADBEEF
 
+/* Marks BootConfig_t.swap as an install/rollback in progress */
+#define SWAP_MAGIC    0x53574150  /* "SWAP" */
+
+/* BL_SwapProgress_t.flags bit: the swap restores the backup */
+#define BL_SWAP_ROLLBACK  (1UL << 31)
+
+/* Rollback whose displaced image is already stored: no BACKUP steps, S6 is kept */
+#define BL_SWAP_KEPT      (1UL << 30)
+
+/* With BL_SWAP_KEPT: INSTALL decrypts the S6 backup straight into S5 */
+#define BL_SWAP_DIRECT    (1UL << 29)
+
+/* Update staged in the RAM window instead of scratch (lost on reset) */
+#define BL_SWAP_RAM       (1UL << 28)
+
+/* Update without backup: INSTALL decrypts the package in S6 straight into S5 */
+#define BL_SWAP_OVERWRITE (1UL << 27)
+
+/* Marks BootConfig_t.xip as holding the slot to run (BL_XIP_AB builds) */
+#define XIP_MAGIC     0x58495021  /* "XIP!" */
+
+/*
+ * Build options — override with -D in CMakeLists.txt.
+ *
+ * BL_FUSED_VERIFY: hash S6 while decrypting it into scratch and check the
+ * signature at the end, instead of a separate verification pass.
+ *
+ * BL_AES_TTABLE: run the software AES on 32-bit lookup tables
+ * (aes_ttable.c, 2.5 KB of RAM) instead of byte-wise TinyCrypt.
+ *
+ * BL_BACKUP_CHACHA20: encrypt the S5 -> S6 backup with ChaCha20 instead
+ * of AES-128-ECB. Rollback reads either format from the backup trailer.
+ *
+ * BL_ECDSA_COMB: verify signatures with the precomputed comb tables in
+ * ecdsa_comb_g.c and keys.c (2 KB of flash each) instead of
+ * uECC_verify(). Needs ECDSA_public_key_comb to match the public key.
+ *
+ * BL_P256_UNROLLED: run the comb verifier's field multiplies on the
+ * unrolled P-256 kernels in p256_field.c instead of TinyCrypt's generic
+ * multi-precision loops.
+ *
+ * BL_XIP_AB: run the application in place from S5 or S6, each holding a
+ * signed plaintext image linked for its own slot (generate_update.py
+ * --xip). The signature covers the footer version the slot is chosen
+ * by. An update or rollback only changes which slot is started;
+ * nothing is decrypted, backed up or copied.
+ *
+ * BL_OVERWRITE_ONLY: install every update as if its header carried
+ * FW_FLAG_OVERWRITE: verify S6, then decrypt it straight into S5. No
+ * scratch copy and no backup, so there is nothing to roll back to; a
+ * device recovers by being sent the firmware again.
+ */
+#ifndef BL_FUSED_VERIFY
+#define BL_FUSED_VERIFY  1
+#endif
+
+#ifndef BL_AES_TTABLE
+#define BL_AES_TTABLE    1
+#endif
+
+#ifndef BL_BACKUP_CHACHA20
+#define BL_BACKUP_CHACHA20  0
+#endif
+
+#ifndef BL_ECDSA_COMB
+#define BL_ECDSA_COMB       1
+#endif
+
+#ifndef BL_P256_UNROLLED
+#define BL_P256_UNROLLED    1
+#endif
+
+#ifndef BL_XIP_AB
+#define BL_XIP_AB           0
+#endif
+
+#ifndef BL_OVERWRITE_ONLY
+#define BL_OVERWRITE_ONLY   0
+#endif
+
 /* System States */
 typedef enum {
     STATE_NORMAL     = 4,
@@ -23,11 +104,57 @@ typedef enum {
     STATE_ROLLBACK   = 6
 } BL_System_Status_t;
 
+/*
+ * Progress of an install or rollback, saved after every step so that a
+ * reset resumes the swap instead of booting a half-written active slot.
+ */
+typedef struct {
+    uint32_t magic;         /* SWAP_MAGIC while a swap is in progress     */
+    uint32_t flags;         /* FW_FLAG_* of the update | BL_SWAP_ROLLBACK */
+    uint32_t steps_done;    /* Completed steps (3 per unit)               */
+    uint32_t unit_size;     /* Bytes moved per unit                       */
+    uint32_t image_size;    /* Length of the image being installed        */
+    uint32_t image_version; /* Version of the image being installed       */
+    uint32_t backup_len;    /* Bytes of the active slot being backed up   */
+    uint32_t data_offset;   /* Ciphertext start in S6 (updates only)      */
+    uint32_t data_len;      /* Ciphertext length (updates only)           */
+    uint32_t backup_nonce;  /* ChaCha20 nonce of the new backup, 0 = ECB  */
+    uint8_t  stage_iv[16];  /* ChaCha20 nonce + counter of the STAGE data */
+} BL_SwapProgress_t;
+
+/*
+ * Slot selection of a BL_XIP_AB build, which never swaps. Shares the
+ * config words of BL_SwapProgress_t; XIP_MAGIC cannot be read as a swap.
+ */
+typedef struct {
+    uint32_t magic;         /* XIP_MAGIC once a slot has been selected    */
+    uint32_t boot_slot;     /* Start address of the slot to run           */
+} BL_XipState_t;
+
 /* Persistent boot configuration (stored in flash config sector) */
 typedef struct {
     uint32_t magic_number;    /* CONFIG_MAGIC when valid                 */
     uint32_t system_status;   /* BL_System_Status_t                     */
     uint32_t current_version; /* Currently running firmware version      */
+    uint32_t current_size;    /* Image length in the active slot, 0 = unknown */
+    union {
+        BL_SwapProgress_t swap; /* Interrupted swap, if swap.magic is set  */
+        BL_XipState_t     xip;  /* Slot to run (BL_XIP_AB builds)          */
+    };
 } BootConfig_t;
 
+/*
+ * The two config sectors hold an append-only log of these records. The
+ * newest record with a good CRC holds the current config. When its sector
+ * has no free slot left, the other sector is erased and the log continues
+ * there, so the newest record is never erased. Padded to 96 bytes so records never
+ * share a flash word on parts with ECC. Read and appended by BL_ConfigLog.c.
+ */
+typedef struct {
+    uint32_t     seq;         /* Incremented for every record written   */
+    BootConfig_t cfg;
+    uint32_t     reserved[4]; /* 0xFFFFFFFF                             */
+    uint32_t     crc;         /* CRC-32 of all fields above             */
+} BL_ConfigRecord_t;
+
 #endif /* INC_BOOTLOADER_CONFIG_H_ */
@@ -0,0 +1,21 @@
+/*
+ * chacha20.h
+ *
+ * ChaCha20 stream cipher (RFC 8439): 256-bit key, 96-bit nonce,
+ * 32-bit block counter. Platform-independent — used by
+ * crypto_driver_sw.c.
+ */
+
+#ifndef INC_CHACHA20_H_
+#define INC_CHACHA20_H_
+
+#include <stdint.h>
+
+/*
+ * XORs len bytes of keystream into in, starting at 64-byte block
+ * `counter`. in and out may be the same buffer.
+ */
+void ChaCha20_Xor(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                  const uint8_t *in, uint8_t *out, uint32_t len);
+
+#endif /* INC_CHACHA20_H_ */
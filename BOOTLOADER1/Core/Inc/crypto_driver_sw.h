@@ -13,10 +13,26 @@
 #define INC_CRYPTO_DRIVER_SW_H_
 
 #include <stdint.h>
+#include "system_interface.h"
 
 int SW_AES_EncryptBlock(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]);
 int SW_AES_DecryptBlock(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]);
+int SW_AES_Init(BL_AesCtx_t *ctx, const uint8_t key[16]);
+int SW_AES_CBC_Decrypt(const BL_AesCtx_t *ctx, const uint8_t iv[16],
+                       const uint8_t *in, uint8_t *out, uint32_t len);
+int SW_AES_ECB_Encrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len);
+int SW_AES_ECB_Decrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len);
+int SW_AES_CTR_Xor(const BL_AesCtx_t *ctx, const uint8_t ctr[16],
+                   const uint8_t *in, uint8_t *out, uint32_t len);
+int SW_CHACHA20_Xor(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                    const uint8_t *in, uint8_t *out, uint32_t len);
+int SW_POLY1305_Init(BL_PolyCtx_t *ctx, const uint8_t key[32]);
+int SW_POLY1305_Update(BL_PolyCtx_t *ctx, const uint8_t *data, uint32_t len);
+int SW_POLY1305_Final(BL_PolyCtx_t *ctx, uint8_t tag[16]);
 int SW_SHA256(const uint8_t *data, uint32_t len, uint8_t digest[32]);
+int SW_SHA256_Init(BL_HashCtx_t *ctx);
+int SW_SHA256_Update(BL_HashCtx_t *ctx, const uint8_t *data, uint32_t len);
+int SW_SHA256_Final(BL_HashCtx_t *ctx, uint8_t digest[32]);
 int SW_ECDSA_Verify(const uint8_t *pub_key, const uint8_t *hash,
                     uint32_t hash_len, const uint8_t *sig);
 
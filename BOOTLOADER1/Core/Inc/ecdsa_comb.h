@@ -0,0 +1,39 @@
+/*
+ * ecdsa_comb.h
+ *
+ * ECDSA P-256 verification with precomputed comb tables for the base
+ * point G and for the embedded public key. Both tables are generated by
+ * Key/extract_pubkey.py and stored in flash; the field arithmetic is
+ * TinyCrypt's. Platform-independent — used by crypto_driver_sw.c.
+ */
+
+#ifndef INC_ECDSA_COMB_H_
+#define INC_ECDSA_COMB_H_
+
+#include <stdint.h>
+
+/* Comb width: must match COMB_TEETH in extract_pubkey.py */
+#define ECDSA_COMB_TEETH   5
+#define ECDSA_COMB_POINTS  ((1U << ECDSA_COMB_TEETH) - 1U)
+#define ECDSA_COMB_ROWS    ((256U + ECDSA_COMB_TEETH - 1U) / ECDSA_COMB_TEETH)
+
+/*
+ * points[j - 1] = sum of 2^(i * ECDSA_COMB_ROWS) * P over the bits i set
+ * in j. Affine, x then y, each as 8 little-endian 32-bit words.
+ */
+typedef struct {
+    uint8_t  public_key[64];    /* P the table was built for (X || Y, big-endian) */
+    uint32_t points[ECDSA_COMB_POINTS][16];
+} ECDSA_CombTable_t;
+
+/* Table for the P-256 base point (ecdsa_comb_g.c) */
+extern const ECDSA_CombTable_t ECDSA_G_comb;
+
+/*
+ * Verifies sig (r || s) over hash for the key of table q.
+ * @retval 1 if the signature is valid, 0 otherwise.
+ */
+int ECDSA_Comb_Verify(const ECDSA_CombTable_t *q, const uint8_t *hash,
+                      uint32_t hash_len, const uint8_t *sig);
+
+#endif /* INC_ECDSA_COMB_H_ */
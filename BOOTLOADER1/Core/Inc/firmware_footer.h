@@ -13,6 +13,40 @@
 /* Magic marker — bootloader scans backwards to find this */
 #define FOOTER_MAGIC 0x454E4421  /* ASCII "END!" */
 
+/* Header magic — marks a package that records where its footer is */
+#define HEADER_MAGIC 0x48445221  /* ASCII "HDR!" */
+
+/* Backup trailer magic — last word of the backup slot */
+#define BACKUP_MAGIC 0x42414B21  /* ASCII "BAK!" */
+
+/* Backup trailer magic when a blank map sits in front of the trailer */
+#define BACKUP_MAP_MAGIC 0x42414B4D  /* ASCII "BAKM" */
+
+/* fw_header_t.flags — package options */
+#define FW_FLAG_LZ4          (1U << 0)  /* Plaintext is an LZ4 block stream */
+#define FW_FLAG_CHACHA20     (1U << 1)  /* ChaCha20 instead of AES-128-CBC   */
+#define FW_FLAG_AES_CTR      (1U << 2)  /* AES-128-CTR instead of AES-128-CBC */
+#define FW_FLAG_AEAD         (1U << 3)  /* ChaCha20-Poly1305, signed manifest */
+#define FW_FLAG_CHUNKED      (1U << 4)  /* Signed digest per FW_CHUNK_SIZE    */
+#define FW_FLAG_OVERWRITE    (1U << 5)  /* Install over S5, keep no backup    */
+#define FW_FLAGS_SUPPORTED   (FW_FLAG_LZ4 | FW_FLAG_CHACHA20 | FW_FLAG_AES_CTR | \
+                              FW_FLAG_AEAD | FW_FLAG_CHUNKED | FW_FLAG_OVERWRITE)
+#define FW_FLAGS_CIPHER      (FW_FLAG_CHACHA20 | FW_FLAG_AES_CTR)
+
+/* Domain label for deriving the ChaCha20 key from the AES key */
+#define FW_CHACHA20_KEY_LABEL  "BL ChaCha20 key"
+
+/* FW_FLAG_AEAD: Poly1305 tag, then SHA-256 of the ciphertext, before the footer */
+#define FW_AEAD_TAG_SIZE     16U
+#define FW_AEAD_DIGEST_SIZE  32U
+
+/* FW_FLAG_CHUNKED: ciphertext bytes per digest, and digest size */
+#define FW_CHUNK_SIZE        4096U
+#define FW_CHUNK_DIGEST_SIZE 32U
+
+/* Decompressed size of every LZ4 block except the last */
+#define FW_LZ4_BLOCK_SIZE    4096U
+
 /* Firmware validation status codes */
 typedef enum {
     BL_OK = 0,
@@ -23,14 +57,104 @@ typedef enum {
     BL_ERR_VECTOR_BAD,
     BL_ERR_HASH_FAIL,
     BL_ERR_SIG_FAIL,
+    BL_ERR_FLASH_FAIL,
+    BL_ERR_TAG_FAIL,
+    BL_ERR_CHUNK_FAIL,
+    BL_ERR_DIGEST_FAIL,
 } FW_Status_t;
 
+/*
+ * Header at the start of the payload (before the IV). It lets the
+ * bootloader locate the footer with one read instead of a backward scan.
+ * It is part of the signed payload. Images without it are still
+ * accepted (legacy layout: payload starts directly with the IV).
+ *
+ * With FW_FLAG_CHACHA20 the 16-byte IV field holds the 12-byte nonce
+ * followed by the initial block counter (little-endian), and the key is
+ * SHA-256(FW_CHACHA20_KEY_LABEL || AES key).
+ *
+ * With FW_FLAG_AES_CTR the IV field is the counter block of the first
+ * ciphertext byte, incremented as a 128-bit big-endian number per block.
+ * CTR data is not padded beyond the 4-byte alignment of the footer.
+ *
+ * FW_FLAG_AEAD (only together with FW_FLAG_CHACHA20) makes the package
+ * ChaCha20-Poly1305 as in RFC 8439: the header is the associated data,
+ * the IV counter word is 1 and the 16-byte tag follows the ciphertext,
+ * then the SHA-256 of the ciphertext. The signature covers only the
+ * manifest SHA-256(header || IV || tag || digest). The tag and the digest
+ * are both checked in the pass that decrypts the ciphertext: the tag key
+ * derives from the device AES key, so only the digest binds the data to
+ * the signature.
+ *
+ * FW_FLAG_CHUNKED (any cipher but AEAD) puts a SHA-256 of every
+ * FW_CHUNK_SIZE bytes of ciphertext between the data and the footer, and
+ * the signature covers SHA-256(header || IV || digests). Each chunk is
+ * checked before it is decrypted, so a bad one stops the install early.
+ * With T = footer.size - 32 (header and IV), there are
+ * n = ceil(T / (FW_CHUNK_SIZE + 32)) digests and T - 32 n data bytes.
+ *
+ * FW_FLAG_OVERWRITE asks for the install that BL_OVERWRITE_ONLY builds
+ * always do: S6 is verified, then decrypted straight into S5, and the
+ * image it replaces is not backed up.
+ */
+typedef struct {
+    uint32_t magic;         /* HEADER_MAGIC                          */
+    uint32_t footer_offset; /* Footer offset from slot start         */
+    uint32_t flags;         /* FW_FLAG_* package options             */
+    uint32_t image_size;    /* Plaintext firmware size (bytes)       */
+} fw_header_t;
+
 /* Footer appended after the encrypted firmware payload */
 typedef struct {
     uint32_t version;       /* Firmware Version                      */
-    uint32_t size;          /* Payload Size (IV + Encrypted Data)    */
+    uint32_t size;          /* Payload Size ([Header] + IV + Data [+ Tag/Digests]) */
     uint8_t  signature[64]; /* ECDSA Signature (r + s, 32 bytes each)*/
     uint32_t magic;         /* FOOTER_MAGIC                          */
 } fw_footer_t;
 
+/*
+ * Trailer in the last 16 bytes of the backup slot, written after the
+ * encrypted backup data. Records how much of the slot holds backup data,
+ * so rollback only processes the real image. A backup without it
+ * (legacy, or an image that fills the slot) covers the whole slot.
+ */
+typedef struct {
+    uint32_t length;        /* Backed-up bytes (multiple of 16)      */
+    uint32_t version;       /* Firmware version of the backup        */
+    uint32_t nonce;         /* ChaCha20 backup nonce, 0 = AES-128-ECB */
+    uint32_t magic;         /* BACKUP_MAGIC or BACKUP_MAP_MAGIC      */
+} fw_backup_trailer_t;
+
+/* Granularity and reach of the backup blank map */
+#define FW_BACKUP_BLOCK_SIZE  1024U
+#define FW_BACKUP_MAP_BLOCKS  256U
+
+/*
+ * Blank map, just before a BACKUP_MAP_MAGIC trailer. Bit i set: backup
+ * block i (FW_BACKUP_BLOCK_SIZE bytes) was erased in the active slot, so
+ * it was neither encrypted nor programmed and rollback leaves it erased.
+ * Blocks past FW_BACKUP_MAP_BLOCKS are always encrypted. digest lets a
+ * rollback compare the backup with the other slots without restoring it.
+ */
+typedef struct {
+    uint32_t blank[FW_BACKUP_MAP_BLOCKS / 32];
+    uint8_t  digest[32];    /* SHA-256 of the backed-up plaintext    */
+} fw_backup_map_t;
+
+/* Scratch mirror magic — last word of the scratch slot */
+#define MIRROR_MAGIC 0x4D495252  /* ASCII "MIRR" */
+
+/*
+ * Trailer in the last 48 bytes of the scratch slot: the slot holds this
+ * image in plaintext and serves as the rollback copy in place of the
+ * backup in S6 (see BL_SWAP_KEPT).
+ */
+typedef struct {
+    uint8_t  digest[32];    /* SHA-256 of the image                  */
+    uint32_t length;        /* Image bytes at the start of the slot  */
+    uint32_t version;       /* Firmware version of the image         */
+    uint32_t reserved;      /* 0xFFFFFFFF                            */
+    uint32_t magic;         /* MIRROR_MAGIC                          */
+} fw_mirror_trailer_t;
+
 #endif /* INC_FIRMWARE_FOOTER_H_ */
@@ -9,9 +9,11 @@
 #define INC_KEYS_H_
 
 #include <stdint.h>
+#include "ecdsa_comb.h"
 
 // Use 'extern' to declare the variables without defining them
 extern const uint8_t AES_SECRET_KEY[16];
 extern const uint8_t ECDSA_public_key_xy[64]; // Adjust size as per your array
+extern const ECDSA_CombTable_t ECDSA_public_key_comb;
 
 #endif /* INC_KEYS_H_ */
@@ -8,9 +8,17 @@
 #define INC_MEM_LAYOUT_H_
 
 #define CONFIG_SECTOR_ADDR       0x08010000  /* Sector 2  — Boot config    */
+#define CONFIG_SECTOR_SIZE       0x00008000  /* 32 KB config record log    */
+#define CONFIG_ALT_SECTOR_ADDR   0x08018000  /* Sector 3  — Config log, 2nd */
 #define APP_ACTIVE_START_ADDR    0x08040000  /* Sector 5  — Active app     */
 #define APP_DOWNLOAD_START_ADDR  0x08080000  /* Sector 6  — Download slot  */
 #define SCRATCH_ADDR             0x080C0000  /* Sector 7  — Scratch buffer */
 #define SLOT_SIZE                0x00040000  /* 256 KB per slot             */
+#define SLOT_SECTOR_SIZE         0x00040000  /* Each slot is one sector     */
+
+/* SRAM1 window for RAM-staged installs (0 = stage in sector 7 only).
+   The linker script must keep .data/.bss below it and the stack above. */
+#define RAM_STAGE_ADDR           0x20010000
+#define RAM_STAGE_SIZE           0x00030000  /* 192 KB                      */
 
 #endif /* INC_MEM_LAYOUT_H_ */
@@ -0,0 +1,24 @@
+/*
+ * p256_field.h
+ *
+ * Unrolled secp256r1 (P-256) field multiply, square and reduce for
+ * 32-bit targets. Operands are 8 little-endian 32-bit words (TinyCrypt's
+ * native order), fully reduced mod p. Platform-independent — used by
+ * ecdsa_comb.c when BL_P256_UNROLLED is set.
+ */
+
+#ifndef INC_P256_FIELD_H_
+#define INC_P256_FIELD_H_
+
+#include <stdint.h>
+
+/* result = a * b mod p. result may alias a or b. */
+void P256_Mul(uint32_t result[8], const uint32_t a[8], const uint32_t b[8]);
+
+/* result = a^2 mod p. result may alias a. */
+void P256_Sqr(uint32_t result[8], const uint32_t a[8]);
+
+/* result = product mod p, for any 512-bit product. */
+void P256_Reduce(uint32_t result[8], const uint32_t product[16]);
+
+#endif /* INC_P256_FIELD_H_ */
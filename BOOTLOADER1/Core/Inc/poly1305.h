@@ -0,0 +1,30 @@
+/*
+ * poly1305.h
+ *
+ * Poly1305 one-time authenticator (RFC 8439), streaming. 32-bit limbs
+ * only, no tables. Platform-independent — used by crypto_driver_sw.c.
+ */
+
+#ifndef INC_POLY1305_H_
+#define INC_POLY1305_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t r[5];          /* Clamped key r, 26-bit limbs      */
+    uint32_t h[5];          /* Accumulator, 26-bit limbs        */
+    uint32_t pad[4];        /* Key s                            */
+    uint32_t leftover;      /* Bytes waiting in buffer          */
+    uint32_t final;         /* Set while the last block runs    */
+    uint8_t  buffer[16];
+} Poly1305_Ctx_t;
+
+/* key: r || s, 32 bytes, used for one message only */
+void Poly1305_Init(Poly1305_Ctx_t *ctx, const uint8_t key[32]);
+
+/* Accepts any length; partial blocks are buffered. */
+void Poly1305_Update(Poly1305_Ctx_t *ctx, const uint8_t *data, uint32_t len);
+
+void Poly1305_Final(Poly1305_Ctx_t *ctx, uint8_t tag[16]);
+
+#endif /* INC_POLY1305_H_ */
@@ -0,0 +1,21 @@
+/*
+ * system_driver_posix.h
+ *
+ * Host (POSIX) platform driver. SystemReset() returns to
+ * posix_reset_point, which main() sets before calling Bootloader_Run();
+ * the other exits end the process with one of the codes below.
+ */
+
+#ifndef INC_SYSTEM_DRIVER_POSIX_H_
+#define INC_SYSTEM_DRIVER_POSIX_H_
+
+#include <setjmp.h>
+
+#define POSIX_EXIT_APP         0  /* JumpToApp() reached a valid image */
+#define POSIX_EXIT_HALT        1  /* ErrorHandler() or host I/O failure */
+#define POSIX_EXIT_RESET_LOOP  2  /* Too many resets in one run        */
+#define POSIX_EXIT_CUT         3  /* Power cut by BL_SIM_CUT_AT        */
+
+extern jmp_buf posix_reset_point;
+
+#endif /* INC_SYSTEM_DRIVER_POSIX_H_ */
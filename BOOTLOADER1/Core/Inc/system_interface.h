@@ -21,23 +21,82 @@
 /* Memory layout descriptor — populated by the platform driver */
 typedef struct {
     uint32_t config_addr;       /* Boot config sector start address       */
+    uint32_t config_size;       /* Boot config sector size (record log)   */
+    uint32_t config_alt_addr;   /* Second config sector, same size        */
     uint32_t app_active_addr;   /* Active application slot  (e.g. S5)    */
     uint32_t app_download_addr; /* Download / backup slot   (e.g. S6)    */
     uint32_t scratch_addr;      /* Scratch / buffer slot    (e.g. S7)    */
     uint32_t slot_size;         /* Size of each application slot (bytes) */
+    uint32_t sector_size;       /* Erase sector inside the slots, 0 = slot */
     uint32_t flash_base;        /* Flash base address (for vector check) */
     uint32_t ram_base;          /* RAM  base address (for SP validation) */
+    uint32_t ram_stage_addr;    /* RAM window an update can be staged in  */
+    uint32_t ram_stage_size;    /* Its size, 0 = always stage in scratch  */
 } BL_MemoryMap_t;
 
+/*
+ * Streaming hash context. Opaque to the portable layer; sized to hold the
+ * state of any backend (TinyCrypt needs 112 bytes).
+ */
+typedef struct {
+    uint64_t opaque[16];
+} BL_HashCtx_t;
+
+/*
+ * Prepared AES-128 key. Opaque to the portable layer; sized to hold the
+ * encrypt and decrypt round keys of any backend.
+ */
+typedef struct {
+    uint32_t opaque[96];
+} BL_AesCtx_t;
+
+/*
+ * Poly1305 authenticator state, keyed for one message. Opaque to the
+ * portable layer (the software backend needs 80 bytes).
+ */
+typedef struct {
+    uint32_t opaque[24];
+} BL_PolyCtx_t;
+
 /*
  * Cryptographic operations — can be backed by software (TinyCrypt)
  * or hardware accelerators (CRYP, HASH peripherals, etc.).
  * Return convention: 0 = success, non-zero = error.
+ *
+ * AES_Init expands a key once; the CBC/ECB calls then process len bytes
+ * (a multiple of 16) per call with that context. For CBC, iv may point
+ * at the ciphertext block just before in, as it does in a package.
+ *
+ * AES_CTR_Xor applies the AES-CTR keystream starting at counter block
+ * ctr (128-bit big-endian increment). CHACHA20_Xor applies the RFC 8439
+ * keystream from 64-byte block `counter` on. Both encrypt and decrypt,
+ * and len need not be a multiple of 16.
+ *
+ * POLY1305_Init/Update/Final compute the RFC 8439 one-time MAC of the
+ * data passed to Update, in pieces of any length.
+ *
+ * SHA256 is one-shot; SHA256_Init/Update/Final hash data incrementally so
+ * a copy or decrypt loop can hash in the same pass that moves the data.
  */
 typedef struct {
     int (*AES_EncryptBlock)(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]);
     int (*AES_DecryptBlock)(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]);
+    int (*AES_Init)(BL_AesCtx_t *ctx, const uint8_t key[16]);
+    int (*AES_CBC_Decrypt)(const BL_AesCtx_t *ctx, const uint8_t iv[16],
+                           const uint8_t *in, uint8_t *out, uint32_t len);
+    int (*AES_ECB_Encrypt)(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len);
+    int (*AES_ECB_Decrypt)(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len);
+    int (*AES_CTR_Xor)(const BL_AesCtx_t *ctx, const uint8_t ctr[16],
+                       const uint8_t *in, uint8_t *out, uint32_t len);
+    int (*CHACHA20_Xor)(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                        const uint8_t *in, uint8_t *out, uint32_t len);
+    int (*POLY1305_Init)(BL_PolyCtx_t *ctx, const uint8_t key[32]);
+    int (*POLY1305_Update)(BL_PolyCtx_t *ctx, const uint8_t *data, uint32_t len);
+    int (*POLY1305_Final)(BL_PolyCtx_t *ctx, uint8_t tag[16]);
     int (*SHA256)(const uint8_t *data, uint32_t len, uint8_t digest[32]);
+    int (*SHA256_Init)(BL_HashCtx_t *ctx);
+    int (*SHA256_Update)(BL_HashCtx_t *ctx, const uint8_t *data, uint32_t len);
+    int (*SHA256_Final)(BL_HashCtx_t *ctx, uint8_t digest[32]);
     int (*ECDSA_Verify)(const uint8_t *pub_key, const uint8_t *hash,
                         uint32_t hash_len, const uint8_t *sig);
 } BL_CryptoOps_t;
@@ -72,7 +131,7 @@ typedef struct {
 
     /* Critical */
     void     (*ErrorHandler)(void);
-    void     (*JumpToApp)(void);
+    void     (*JumpToApp)(uint32_t app_addr); /* Vector table at app_addr */
     void     (*DisableIRQ)(void);
     void     (*EnableIRQ)(void);
 } Bootloader_Interface_t;
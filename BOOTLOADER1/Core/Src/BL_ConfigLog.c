@@ -0,0 +1,182 @@
+/**
+ * @file    BL_ConfigLog.c
+ * @brief   Append-only boot config log in two flash sectors.
+ * @details Used by the bootloader through BL_ReadConfig()/BL_WriteConfig()
+ * and by applications directly. Depends on no bootloader state: the
+ * sectors and flash routines come in a BL_ConfigFlash_t.
+ */
+
+#include "BL_ConfigLog.h"
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(sizeof(BL_ConfigRecord_t) % 32 == 0, "config record must fill whole flash words");
+
+/* CRC-32 (IEEE 802.3), bitwise: records are small and written rarely */
+static uint32_t BL_Crc32(const uint8_t *data, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+
+    while (len--) {
+        crc ^= *data++;
+        for (int k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0U - (crc & 1U)));
+    }
+    return ~crc;
+}
+
+static const BL_ConfigRecord_t *BL_Config_Record(uint32_t base, uint32_t index) {
+    return (const BL_ConfigRecord_t *)(base + index * sizeof(BL_ConfigRecord_t));
+}
+
+static uint8_t BL_Config_Record_Valid(const BL_ConfigRecord_t *rec) {
+    return rec->cfg.magic_number == CONFIG_MAGIC &&
+           rec->crc == BL_Crc32((const uint8_t *)rec, offsetof(BL_ConfigRecord_t, crc));
+}
+
+/*
+ * An application built before the log wrote a bare BootConfig_t at the
+ * start of the first sector. A record there starts with its seq instead.
+ */
+static const BootConfig_t *BL_Config_Legacy(const BL_ConfigFlash_t *flash) {
+    const BootConfig_t *bare = (const BootConfig_t *)flash->addr;
+
+    if (bare->magic_number != CONFIG_MAGIC || BL_Config_Record_Valid(BL_Config_Record(flash->addr, 0)))
+        return NULL;
+    return bare;
+}
+
+/*
+ * Records are appended in order, so the used slots form a prefix of the
+ * sector: binary search for its end instead of walking every record.
+ */
+static uint32_t BL_Config_Used(const BL_ConfigFlash_t *flash, uint32_t base) {
+    uint32_t lo = 0;
+    uint32_t hi = flash->size / sizeof(BL_ConfigRecord_t);
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (BL_Config_Record(base, mid)->seq != 0xFFFFFFFF)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Newest good record below `used`; a record torn by a reset fails its CRC */
+static const BL_ConfigRecord_t *BL_Config_Latest(uint32_t base, uint32_t used) {
+    while (used > 0) {
+        const BL_ConfigRecord_t *rec = BL_Config_Record(base, --used);
+        if (BL_Config_Record_Valid(rec))
+            return rec;
+    }
+    return NULL;
+}
+
+/*
+ * The log alternates between two sectors. The one holding the newest good
+ * record is current; *base is set to it (the first sector if both are
+ * empty). The other sector is only erased to take the next record, so a
+ * reset during that erase or write still finds the previous record.
+ */
+static const BL_ConfigRecord_t *BL_Config_Newest(const BL_ConfigFlash_t *flash, uint32_t *base) {
+    const BL_ConfigRecord_t *a = BL_Config_Latest(flash->addr, BL_Config_Used(flash, flash->addr));
+    const BL_ConfigRecord_t *b = BL_Config_Latest(flash->alt_addr,
+                                                  BL_Config_Used(flash, flash->alt_addr));
+
+    if (b && (!a || b->seq > a->seq)) {
+        *base = flash->alt_addr;
+        return b;
+    }
+    *base = flash->addr;
+    return a;
+}
+
+uint8_t BL_Config_Read(const BL_ConfigFlash_t *flash, BootConfig_t *cfg) {
+    uint32_t base;
+    const BootConfig_t *bare = BL_Config_Legacy(flash);
+    const BL_ConfigRecord_t *rec = BL_Config_Newest(flash, &base);
+
+    if (bare) {
+        /* Written over the log by an older application: it is the newest */
+        memcpy(cfg, bare, sizeof(BootConfig_t));
+    } else if (rec) {
+        memcpy(cfg, &rec->cfg, sizeof(BootConfig_t));
+    } else {
+        memset(cfg, 0xFF, sizeof(BootConfig_t));
+    }
+
+    if (cfg->magic_number != CONFIG_MAGIC) {
+        cfg->magic_number    = CONFIG_MAGIC;
+        cfg->system_status   = STATE_NORMAL;
+        cfg->current_version = 0;
+        cfg->current_size    = 0;
+        memset(&cfg->swap, 0, sizeof(cfg->swap));
+        return 1;
+    }
+
+    /* Configs written before current_size existed read back as erased */
+    if (cfg->current_size == 0xFFFFFFFF)
+        cfg->current_size = 0;
+
+    /* ... and a bare one from before the swap words has erased ones */
+    if (bare && cfg->swap.magic == 0xFFFFFFFF)
+        memset(&cfg->swap, 0, sizeof(cfg->swap));
+
+    return 0;
+}
+
+/*
+ * Sequence number of the next record. The log keeps counting across
+ * sector erases, so every swap gets its own value.
+ */
+uint32_t BL_Config_Next_Seq(const BL_ConfigFlash_t *flash) {
+    uint32_t base;
+    const BL_ConfigRecord_t *last = BL_Config_Newest(flash, &base);
+    return last ? last->seq + 1 : 1;
+}
+
+uint8_t BL_Config_Append(const BL_ConfigFlash_t *flash, const BootConfig_t *cfg) {
+    uint32_t slots = flash->size / sizeof(BL_ConfigRecord_t);
+    uint32_t base;
+    const BL_ConfigRecord_t *last = BL_Config_Newest(flash, &base);
+    uint8_t  legacy = BL_Config_Legacy(flash) != NULL;
+    uint32_t used  = BL_Config_Used(flash, base);
+    BL_ConfigRecord_t rec;
+
+    if (!legacy && last && memcmp(&last->cfg, cfg, sizeof(BootConfig_t)) == 0)
+        return 1;
+
+    rec.seq      = last ? last->seq + 1 : 1;
+    rec.cfg      = *cfg;
+    memset(rec.reserved, 0xFF, sizeof(rec.reserved));
+    rec.crc      = BL_Crc32((const uint8_t *)&rec, offsetof(BL_ConfigRecord_t, crc));
+
+    if (legacy) {
+        /* The bare config must go, or it would win over this record */
+        base = flash->addr;
+    } else if (used < slots &&
+               flash->Write(base + used * sizeof(rec), (const uint8_t *)&rec, sizeof(rec)) == 0 &&
+               BL_Config_Record_Valid(BL_Config_Record(base, used))) {
+        return 1;
+    } else {
+        /* Sector full, or the free slot was not clean: continue in the other one */
+        base = (base == flash->addr) ? flash->alt_addr : flash->addr;
+    }
+
+    if (flash->Erase(base, flash->size) != 0)
+        return 0;
+
+    if (flash->Write(base, (const uint8_t *)&rec, sizeof(rec)) != 0)
+        return 0;
+
+    return BL_Config_Record_Valid(BL_Config_Record(base, 0));
+}
+
+uint8_t BL_Config_Request(const BL_ConfigFlash_t *flash, uint32_t state) {
+    BootConfig_t cfg;
+
+    BL_Config_Read(flash, &cfg);
+    cfg.system_status = state;
+    return BL_Config_Append(flash, &cfg);
+}
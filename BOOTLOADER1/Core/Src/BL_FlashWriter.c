@@ -0,0 +1,83 @@
+/**
+ * @file    BL_FlashWriter.c
+ * @brief   Coalescing write-back buffer for flash programming.
+ * @details Sequential writes are gathered into a RAM chunk that is flushed
+ * when it reaches a BL_WRITE_BUF_SIZE boundary, when the next write is not
+ * contiguous, or on an explicit BL_Writer_Flush(). One driver call per
+ * chunk replaces one call (and one unlock/lock) per 16-byte block.
+ *
+ * Return convention: 0 = success, -1 = error (see fail_addr).
+ */
+
+#include "BL_FlashWriter.h"
+#include <string.h>
+
+void BL_Writer_Init(BL_FlashWriter_t *w, const Bootloader_Interface_t *sys) {
+    w->sys       = sys;
+    w->base      = 0;
+    w->fill      = 0;
+    w->fail_addr = 0;
+}
+
+/*
+ * Pinpoints the first byte of the chunk that did not reach flash, so the
+ * caller can report an exact offset instead of the chunk start.
+ */
+static uint32_t BL_Writer_FindFailure(const BL_FlashWriter_t *w) {
+    const uint8_t *flash = (const uint8_t *)w->base;
+
+    for (uint32_t i = 0; i < w->fill; i++) {
+        if (flash[i] != w->buf[i])
+            return w->base + i;
+    }
+    return w->base;
+}
+
+int BL_Writer_Flush(BL_FlashWriter_t *w) {
+    if (w->fill == 0)
+        return 0;
+
+    if (w->sys == NULL) {
+        memcpy((void *)w->base, w->buf, w->fill);
+    } else if (w->sys->Flash_Write(w->base, w->buf, w->fill) != 0) {
+        w->fail_addr = BL_Writer_FindFailure(w);
+        w->fill = 0;
+        return -1;
+    }
+
+    w->base += w->fill;
+    w->fill  = 0;
+    return 0;
+}
+
+int BL_Writer_Put(BL_FlashWriter_t *w, uint32_t address, const uint8_t *data, uint32_t length) {
+    if (w->fail_addr != 0)
+        return -1;
+
+    /* Non-contiguous write: drain what we have and restart here */
+    if (w->fill != 0 && address != w->base + w->fill) {
+        if (BL_Writer_Flush(w) != 0)
+            return -1;
+    }
+
+    while (length > 0) {
+        if (w->fill == 0)
+            w->base = address;
+
+        /* Never let a chunk straddle a BL_WRITE_BUF_SIZE boundary */
+        uint32_t room = BL_WRITE_BUF_SIZE - ((w->base + w->fill) & (BL_WRITE_BUF_SIZE - 1U));
+        uint32_t n    = (length < room) ? length : room;
+
+        memcpy(&w->buf[w->fill], data, n);
+        w->fill += n;
+        address += n;
+        data    += n;
+        length  -= n;
+
+        if (n == room) {
+            if (BL_Writer_Flush(w) != 0)
+                return -1;
+        }
+    }
+    return 0;
+}
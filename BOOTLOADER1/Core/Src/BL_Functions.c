@@ -1,8 +1,8 @@
 /**
  * @file    BL_Functions.c
  * @brief   Implementation of core Bootloader logic.
- * @details Handles configuration management, AES encryption/decryption (CBC/ECB),
- * and the orchestration of Firmware Updates and Rollbacks.
+ * @details Handles configuration management, image encryption/decryption
+ * (AES-CBC/ECB, ChaCha20), and the orchestration of Firmware Updates and Rollbacks.
  *
  * This file is fully portable — all hardware access goes through
  * Bootloader_Interface_t and all crypto through BL_CryptoOps_t.
@@ -11,16 +11,50 @@
  */
 
 #include "BL_Functions.h"
+#include "BL_ConfigLog.h"
+#include "BL_FlashWriter.h"
+#include "BL_Lz4Stream.h"
 #include "keys.h"
 #include "tiny_printf.h"
 #include "Cryptology_Control.h"
 #include "firmware_footer.h"
+#include <stddef.h>
 #include <string.h>
 
 extern const uint8_t AES_SECRET_KEY[];
 
 static const Bootloader_Interface_t *sys = NULL;
 
+/* Batches the 16-byte block writes of the crypto passes */
+static BL_FlashWriter_t writer;
+
+/* Decoder state for compressed update payloads */
+static BL_Lz4Stream_t lz4_stream;
+
+/* Set when the last BL_Swap_Stage() failed on the package data, not on flash */
+static uint8_t stage_bad_data;
+
+/* Expanded AES key, shared by the CBC and ECB passes */
+static BL_AesCtx_t aes_ctx;
+
+/* ChaCha20 key, derived from the AES key on first use */
+static uint8_t chacha_key[32];
+static uint8_t chacha_key_ready = 0;
+
+/* Bytes handed to the bulk AES calls at a time (multiple of 16) */
+#define BL_CRYPTO_CHUNK 256U
+
+_Static_assert(FW_CHUNK_SIZE % BL_CRYPTO_CHUNK == 0, "manifest chunks must be whole crypto chunks");
+_Static_assert(FW_BACKUP_BLOCK_SIZE % BL_CRYPTO_CHUNK == 0, "blank-map blocks must be whole crypto chunks");
+
+/* What the decrypt pass checks as it reads the ciphertext; NULL = skip */
+typedef struct {
+    BL_HashCtx_t  *hash;    /* SHA-256 of the payload (fused verify), or of  */
+                            /* the ciphertext (FW_FLAG_AEAD)                 */
+    BL_PolyCtx_t  *poly;    /* Poly1305 of the ciphertext (FW_FLAG_AEAD)     */
+    const uint8_t *chunks;  /* Digest per FW_CHUNK_SIZE (FW_FLAG_CHUNKED)    */
+} BL_StageAuth_t;
+
 void BL_SetInterface(const Bootloader_Interface_t *iface) {
     sys = iface;
 }
@@ -29,254 +63,1257 @@ void BL_SetInterface(const Bootloader_Interface_t *iface) {
 /* CONFIGURATION                                                              */
 /* ========================================================================== */
 
-uint8_t BL_ReadConfig(BootConfig_t *cfg) {
-    memcpy(cfg, (void *)sys->mem.config_addr, sizeof(BootConfig_t));
+/* The config log lives in the two config sectors of the memory map */
+static BL_ConfigFlash_t BL_Config_Flash(void) {
+    BL_ConfigFlash_t flash = {
+        .addr     = sys->mem.config_addr,
+        .alt_addr = sys->mem.config_alt_addr,
+        .size     = sys->mem.config_size,
+        .Erase    = sys->Flash_Erase,
+        .Write    = sys->Flash_Write,
+    };
+    return flash;
+}
 
-    if (cfg->magic_number != CONFIG_MAGIC) {
-        cfg->magic_number    = CONFIG_MAGIC;
-        cfg->system_status   = STATE_NORMAL;
-        cfg->current_version = 0;
-        return 1;
-    }
-    return 0;
+uint8_t BL_ReadConfig(BootConfig_t *cfg) {
+    BL_ConfigFlash_t flash = BL_Config_Flash();
+    return BL_Config_Read(&flash, cfg);
 }
 
 uint8_t BL_WriteConfig(BootConfig_t *cfg) {
-    if (sys->Flash_Erase(sys->mem.config_addr, sizeof(BootConfig_t)) != 0)
-        return 0;
-
-    if (sys->Flash_Write(sys->mem.config_addr, (uint8_t *)cfg, sizeof(BootConfig_t)) != 0)
-        return 0;
+    BL_ConfigFlash_t flash = BL_Config_Flash();
+    return BL_Config_Append(&flash, cfg);
+}
 
-    return 1;
+uint8_t BL_Swap_Pending(const BootConfig_t *cfg) {
+    return cfg->swap.magic == SWAP_MAGIC;
 }
 
 /* ========================================================================== */
 /* INTERNAL HELPERS                                                           */
 /* ========================================================================== */
 
-static uint8_t BL_Raw_Copy(uint32_t src_addr, uint32_t dest_addr, uint32_t size) {
+#define BL_ALIGN16(x)  (((x) + 15U) & ~15U)
+
+/* Bytes of the active slot that hold the image (whole slot if unknown) */
+static uint32_t BL_Active_Length(const BootConfig_t *cfg) {
+    if (cfg->current_size == 0 || cfg->current_size > sys->mem.slot_size)
+        return sys->mem.slot_size;
+    return BL_ALIGN16(cfg->current_size);
+}
+
+
+/* Keeps flash unlocked for a whole pass. Drivers may leave these NULL. */
+static void BL_Flash_Begin(void) {
+    if (sys->Flash_Unlock) sys->Flash_Unlock();
+}
+
+static void BL_Flash_End(void) {
+    if (sys->Flash_Lock) sys->Flash_Lock();
+}
+
+static void BL_Report_Rate(uint32_t bytes, uint32_t start_tick) {
+    uint32_t ms = sys->GetTick() - start_tick;
+    if (ms == 0) ms = 1;
+    printf("  [DEBUG] %u bytes in %u ms (%u B/s)\r\n",
+           (unsigned int)bytes, (unsigned int)ms,
+           (unsigned int)(((uint64_t)bytes * 1000U) / ms));
+}
+
+static uint8_t BL_Erase_Area(uint32_t addr, uint32_t size) {
     printf("  [DEBUG] Erasing Target Area... ");
-    if (sys->Flash_Erase(dest_addr, size) != 0) {
+    if (sys->Flash_Erase(addr, size) != 0) {
         printf("FAILED! Erase Error.\r\n");
         return 0;
     }
     printf("OK\r\n");
+    return 1;
+}
+
+static uint8_t BL_Is_Erased(uint32_t addr, uint32_t size) {
+    for (uint32_t offset = 0; offset < size; offset += 4) {
+        if (*(volatile uint32_t *)(addr + offset) != 0xFFFFFFFF)
+            return 0;
+    }
+    return 1;
+}
+
+/* Bytes of [offset, length) in the blank-map block that starts at offset */
+static uint32_t BL_Block_Bytes(uint32_t offset, uint32_t length) {
+    uint32_t n = length - offset;
+    return (n < FW_BACKUP_BLOCK_SIZE) ? n : FW_BACKUP_BLOCK_SIZE;
+}
+
+/*
+ * Programs an already erased area. Erased source blocks are skipped:
+ * the destination already reads back the same.
+ */
+static uint8_t BL_Raw_Copy(uint32_t src_addr, uint32_t dest_addr, uint32_t size) {
+    uint32_t written = 0;
 
     printf("  [DEBUG] Writing %d bytes... ", (int)size);
-    if (sys->Flash_Write(dest_addr, (uint8_t *)src_addr, size) != 0) {
-        printf("FAILED! Write Error.\r\n");
-        return 0;
+    uint32_t start = sys->GetTick();
+    BL_Flash_Begin();
+    for (uint32_t i = 0; i < size; ) {
+        uint32_t run = 0;
+
+        while (i < size && BL_Is_Erased(src_addr + i, BL_Block_Bytes(i, size)))
+            i += BL_Block_Bytes(i, size);
+        while (i + run < size && !BL_Is_Erased(src_addr + i + run, BL_Block_Bytes(i + run, size)))
+            run += BL_Block_Bytes(i + run, size);
+
+        if (run != 0 && sys->Flash_Write(dest_addr + i, (uint8_t *)(src_addr + i), run) != 0) {
+            BL_Flash_End();
+            printf("FAILED! Write Error.\r\n");
+            return 0;
+        }
+        written += run;
+        i       += run;
     }
+    BL_Flash_End();
     printf("OK\r\n");
+    if (written != size)
+        printf("  [DEBUG] %u erased bytes skipped\r\n", (unsigned int)(size - written));
+    BL_Report_Rate(size, start);
     return 1;
 }
 
+static uint8_t BL_Map_Blank(const fw_backup_map_t *map, uint32_t block) {
+    return map && block < FW_BACKUP_MAP_BLOCKS && (map->blank[block / 32] & (1UL << (block % 32)));
+}
+
+/*
+ * Marks the blocks of [offset, offset + length) that are erased in the
+ * slot at slot_addr. offset is a multiple of FW_BACKUP_BLOCK_SIZE; the
+ * last block only counts up to offset + length.
+ */
+static void BL_Map_Scan(uint32_t slot_addr, uint32_t offset, uint32_t length, fw_backup_map_t *map) {
+    uint32_t end = offset + length;
+
+    for (uint32_t pos = offset; pos < end; pos += FW_BACKUP_BLOCK_SIZE) {
+        uint32_t block = pos / FW_BACKUP_BLOCK_SIZE;
+        if (block >= FW_BACKUP_MAP_BLOCKS)
+            break;
+        if (BL_Is_Erased(slot_addr + pos, BL_Block_Bytes(pos, end)))
+            map->blank[block / 32] |= 1UL << (block % 32);
+    }
+}
+
+/*
+ * BL_Active_Length() without the erased blocks at the end, which the
+ * rollback gets back by leaving them erased. Keeps at least one block.
+ */
+static uint32_t BL_Backup_Length(const BootConfig_t *cfg) {
+    uint32_t len = BL_Active_Length(cfg);
+
+    while (len > FW_BACKUP_BLOCK_SIZE) {
+        uint32_t last = (len - 1) / FW_BACKUP_BLOCK_SIZE * FW_BACKUP_BLOCK_SIZE;
+        if (!BL_Is_Erased(sys->mem.app_active_addr + last, len - last))
+            break;
+        len = last;
+    }
+    return len;
+}
+
 /* ========================================================================== */
 /* CRYPTOGRAPHIC OPERATIONS                                                   */
 /* ========================================================================== */
 
+static uint8_t BL_Chacha_Key(void) {
+    static const char label[] = FW_CHACHA20_KEY_LABEL;
+    BL_HashCtx_t hash;
+
+    if (chacha_key_ready)
+        return 1;
+
+    if (sys->crypto.SHA256_Init(&hash) != 0 ||
+        sys->crypto.SHA256_Update(&hash, (const uint8_t *)label, sizeof(label) - 1) != 0 ||
+        sys->crypto.SHA256_Update(&hash, AES_SECRET_KEY, 16) != 0 ||
+        sys->crypto.SHA256_Final(&hash, chacha_key) != 0)
+        return 0;
+
+    chacha_key_ready = 1;
+    return 1;
+}
+
+/* Backup stream: nonce word, BACKUP_MAGIC, zero, then counter 0 */
+static void BL_Backup_Iv(uint32_t nonce, uint8_t iv[16]) {
+    uint32_t words[4] = { nonce, BACKUP_MAGIC, 0, 0 };
+    memcpy(iv, words, 16);
+}
+
 /**
- * @brief  Decrypts a new update image using AES-128-CBC.
- * @param  src_slot_addr Start address of the encrypted image (IV + ciphertext).
- * @param  dest_addr     Destination address (Scratchpad).
- * @param  payload_size  Total size of IV + Ciphertext.
- * @retval 1 on success, 0 on failure.
+ * @brief  Applies the ChaCha20 keystream at a position in a stream.
+ * @param  iv     Nonce (12 bytes) and initial block counter (LE) of the stream.
+ * @param  offset Stream position of in[0], a multiple of 64.
+ * @retval 0 on success, non-zero on error.
  */
-static uint8_t BL_Decrypt_Update_Image(uint32_t src_slot_addr,
-                                        uint32_t dest_addr,
-                                        uint32_t payload_size) {
-    uint8_t buffer_enc[16], buffer_dec[16], current_iv[16];
+static int BL_Chacha_Xor(const uint8_t iv[16], uint32_t offset,
+                         const uint8_t *in, uint8_t *out, uint32_t len) {
+    uint32_t counter;
 
-    memcpy(current_iv, (void *)src_slot_addr, 16);
+    memcpy(&counter, iv + 12, 4);
+    return sys->crypto.CHACHA20_Xor(chacha_key, iv, counter + offset / 64, in, out, len);
+}
 
-    uint32_t encrypted_data_size = payload_size - 16;
-    uint32_t data_start_offset   = 16;
+/* Counter block `blocks` blocks after iv (128-bit big-endian add) */
+static void BL_Ctr_Block(const uint8_t iv[16], uint32_t blocks, uint8_t ctr[16]) {
+    uint32_t carry = blocks;
 
-    printf("  [DEBUG] Erasing Scratchpad Area... ");
-    if (sys->Flash_Erase(dest_addr, encrypted_data_size) != 0) {
-        printf("FAILED! Erase Error.\r\n");
-        return 0;
+    for (int j = 15; j >= 0; j--) {
+        carry += iv[j];
+        ctr[j] = (uint8_t)carry;
+        carry >>= 8;
     }
-    printf("OK\r\n");
+}
+
+/**
+ * @brief  Decrypts a run of the update payload into the flash writer.
+ * @param  src_addr  First ciphertext byte; for CBC the IV is the 16 bytes before it.
+ * @param  dest_addr Destination address (ignored when lz4 is used). Bytes
+ *                   past p->image_size, the cipher padding, are not written.
+ * @param  length    Bytes to decrypt (multiple of 16 for CBC).
+ * @param  p         Swap description: cipher flags and stage_iv.
+ * @param  offset    Payload position of src_addr (multiple of 64).
+ * @param  auth      If not NULL, what to check on the ciphertext as it is read.
+ *                   auth->chunks holds the digest of the chunk at src_addr
+ *                   onwards, and offset must then be a multiple of FW_CHUNK_SIZE.
+ * @param  lz4       If not NULL, the plaintext goes through the decoder.
+ * @retval 1 on success, 0 on a crypto error or a chunk digest mismatch
+ *         (checked before the chunk is decrypted). Write errors are left in
+ *         writer.fail_addr / lz4->error for the caller.
+ */
+static uint8_t BL_Decrypt_Run(uint32_t src_addr, uint32_t dest_addr, uint32_t length,
+                              const BL_SwapProgress_t *p, uint32_t offset,
+                              const BL_StageAuth_t *auth, BL_Lz4Stream_t *lz4) {
+    static const BL_StageAuth_t no_auth = { NULL, NULL, NULL };
+    uint8_t plain[BL_CRYPTO_CHUNK];
+    uint8_t ctr[16];
+    uint8_t digest[32];
+    uint32_t cipher_flags = p->flags & FW_FLAGS_CIPHER;
+    int ret;
+
+    if (auth == NULL)
+        auth = &no_auth;
+
+    if (cipher_flags == FW_FLAG_CHACHA20 ? !BL_Chacha_Key()
+                                         : sys->crypto.AES_Init(&aes_ctx, AES_SECRET_KEY) != 0)
+        return 0;
 
-    for (uint32_t i = 0; i < encrypted_data_size; i += 16) {
-        memcpy(buffer_enc, (void *)(src_slot_addr + data_start_offset + i), 16);
+    for (uint32_t i = 0; i < length; i += BL_CRYPTO_CHUNK) {
+        const uint8_t *cipher = (const uint8_t *)(src_addr + i);
+        uint32_t n = length - i;
+        if (n > BL_CRYPTO_CHUNK) n = BL_CRYPTO_CHUNK;
+
+        if (auth->chunks && (i % FW_CHUNK_SIZE) == 0) {
+            uint32_t chunk = (length - i < FW_CHUNK_SIZE) ? length - i : FW_CHUNK_SIZE;
+            const uint8_t *expected = auth->chunks + (i / FW_CHUNK_SIZE) * FW_CHUNK_DIGEST_SIZE;
+
+            if (sys->crypto.SHA256(cipher, chunk, digest) != 0 ||
+                memcmp(digest, expected, FW_CHUNK_DIGEST_SIZE) != 0)
+                return 0;
+        }
 
-        /* AES-CBC: decrypt block, then XOR with previous ciphertext (IV) */
-        if (sys->crypto.AES_DecryptBlock(AES_SECRET_KEY, buffer_enc, buffer_dec) != 0)
+        if (auth->hash && sys->crypto.SHA256_Update(auth->hash, cipher, n) != 0)
+            return 0;
+        if (auth->poly && sys->crypto.POLY1305_Update(auth->poly, cipher, n) != 0)
             return 0;
 
-        for (int j = 0; j < 16; j++)
-            buffer_dec[j] ^= current_iv[j];
-        memcpy(current_iv, buffer_enc, 16);
+        if (cipher_flags == FW_FLAG_CHACHA20) {
+            ret = BL_Chacha_Xor(p->stage_iv, offset + i, cipher, plain, n);
+        } else if (cipher_flags == FW_FLAG_AES_CTR) {
+            BL_Ctr_Block(p->stage_iv, (offset + i) / 16, ctr);
+            ret = sys->crypto.AES_CTR_Xor(&aes_ctx, ctr, cipher, plain, n);
+        } else {
+            /* The CBC chaining value is always the ciphertext block in front */
+            ret = sys->crypto.AES_CBC_Decrypt(&aes_ctx, cipher - 16, cipher, plain, n);
+        }
 
-        if (sys->Flash_Write(dest_addr + i, buffer_dec, 16) != 0) {
-            printf("FAILED! Write Error at offset %d.\r\n", (int)i);
+        if (ret != 0)
             return 0;
+
+        if (lz4) {
+            if (BL_Lz4_Put(lz4, plain, n) != 0)
+                break;
+            continue;
         }
+
+        /* Padding past the image stays erased */
+        uint32_t pos = offset + i;
+        uint32_t w = (pos >= p->image_size) ? 0 : (p->image_size - pos < n) ? p->image_size - pos : n;
+        if (w && BL_Writer_Put(&writer, dest_addr + i, plain, w) != 0)
+            break;
     }
     return 1;
 }
 
+/* Sets up the backup cipher: ChaCha20 if chacha_iv is given, else AES-128-ECB */
+static uint8_t BL_Backup_Key(const uint8_t *chacha_iv) {
+    return chacha_iv ? BL_Chacha_Key() : sys->crypto.AES_Init(&aes_ctx, AES_SECRET_KEY) == 0;
+}
+
+/* Encrypts or decrypts n bytes at backup position pos (multiple of 64) */
+static int BL_Backup_Crypt(uint8_t encrypt, const uint8_t *chacha_iv, uint32_t pos,
+                           const uint8_t *in, uint8_t *out, uint32_t n) {
+    if (chacha_iv)
+        return BL_Chacha_Xor(chacha_iv, pos, in, out, n);
+    if (encrypt)
+        return sys->crypto.AES_ECB_Encrypt(&aes_ctx, in, out, n);
+    return sys->crypto.AES_ECB_Decrypt(&aes_ctx, in, out, n);
+}
+
 /**
- * @brief  Encrypts the active application using AES-128-ECB for backup.
- * @param  src_addr  Source address (Active App).
- * @param  dest_addr Destination address (Backup Slot).
+ * @brief  Encrypts or decrypts part of a backup (AES-128-ECB or ChaCha20).
+ * @param  src_addr  Source address.
+ * @param  dest_addr Destination address (already erased).
+ * @param  length    Bytes to process (multiple of 16).
+ * @param  encrypt   1 to back up, 0 to restore.
+ * @param  chacha_iv ChaCha20 nonce + counter of the backup, NULL for ECB.
+ * @param  offset    Backup position of src/dest (multiple of FW_BACKUP_BLOCK_SIZE).
+ * @param  map       Blocks to leave out (erased on both sides), or NULL.
  * @retval 1 on success, 0 on failure.
  */
-static uint8_t BL_Encrypt_Backup(uint32_t src_addr, uint32_t dest_addr) {
-    uint8_t buffer_plain[16];
-    uint8_t buffer_enc[16];
-    uint32_t slot_size = sys->mem.slot_size;
-
-    sys->DisableIRQ();
+static uint8_t BL_Backup_Run(uint32_t src_addr, uint32_t dest_addr, uint32_t length,
+                             uint8_t encrypt, const uint8_t *chacha_iv, uint32_t offset,
+                             const fw_backup_map_t *map) {
+    uint8_t buffer_out[BL_CRYPTO_CHUNK];
+    uint32_t skipped = 0;
 
-    printf("  [DEBUG] Erasing Backup Area... ");
-    if (sys->Flash_Erase(dest_addr, slot_size) != 0) {
-        sys->EnableIRQ();
-        printf("FAILED! Erase Error.\r\n");
+    if (!BL_Backup_Key(chacha_iv))
         return 0;
-    }
-    printf("OK\r\n");
 
-    printf("  [DEBUG] Encrypting & Backing up %d bytes... \r\n", (int)slot_size);
+    sys->DisableIRQ();
 
-    for (uint32_t offset = 0; offset < slot_size; offset += 16) {
-        memcpy(buffer_plain, (void *)(src_addr + offset), 16);
+    uint32_t start = sys->GetTick();
+    BL_Writer_Init(&writer, sys);
+    BL_Flash_Begin();
 
-        if (sys->crypto.AES_EncryptBlock(AES_SECRET_KEY, buffer_plain, buffer_enc) != 0) {
-            sys->EnableIRQ();
-            return 0;
+    for (uint32_t i = 0, n; i < length; i += n) {
+        const uint8_t *in = (const uint8_t *)(src_addr + i);
+        n = length - i;
+        if (n > BL_CRYPTO_CHUNK) n = BL_CRYPTO_CHUNK;
+
+        if (((offset + i) % FW_BACKUP_BLOCK_SIZE) == 0 &&
+            BL_Map_Blank(map, (offset + i) / FW_BACKUP_BLOCK_SIZE)) {
+            n = BL_Block_Bytes(i, length);
+            skipped += n;
+            continue;
         }
 
-        if (sys->Flash_Write(dest_addr + offset, buffer_enc, 16) != 0) {
+        if (BL_Backup_Crypt(encrypt, chacha_iv, offset + i, in, buffer_out, n) != 0) {
+            BL_Flash_End();
             sys->EnableIRQ();
-            printf("Backup Write Failed at offset 0x%x\r\n", (unsigned int)offset);
             return 0;
         }
+
+        if (BL_Writer_Put(&writer, dest_addr + i, buffer_out, n) != 0)
+            break;
     }
 
+    BL_Writer_Flush(&writer);
+    BL_Flash_End();
     sys->EnableIRQ();
-    printf("  Backup Complete.\r\n");
+
+    if (writer.fail_addr != 0) {
+        printf("%s Write Failed at offset 0x%x\r\n", encrypt ? "Backup" : "Rollback",
+               (unsigned int)(writer.fail_addr - dest_addr));
+        return 0;
+    }
+
+    if (skipped != 0)
+        printf("  [DEBUG] %u erased bytes skipped\r\n", (unsigned int)skipped);
+    BL_Report_Rate(length, start);
     return 1;
 }
 
 /**
- * @brief  Decrypts a backup image using AES-128-ECB for rollback.
- * @param  src_addr  Source address (Backup Slot).
- * @param  dest_addr Destination address (Scratchpad).
- * @retval 1 on success, 0 on failure.
+ * @brief  Reads the backup trailer at the end of the backup slot.
+ * @retval Pointer to the trailer in Flash, or NULL for a legacy backup.
  */
-static uint8_t BL_Decrypt_Backup_Image(uint32_t src_addr, uint32_t dest_addr) {
-    uint8_t buffer_enc[16];
-    uint8_t buffer_dec[16];
+static const fw_backup_trailer_t *BL_Find_Backup_Trailer(uint32_t slot_addr) {
     uint32_t slot_size = sys->mem.slot_size;
+    const fw_backup_trailer_t *trailer =
+        (const fw_backup_trailer_t *)(slot_addr + slot_size - sizeof(fw_backup_trailer_t));
 
-    sys->DisableIRQ();
+    if ((trailer->magic != BACKUP_MAGIC && trailer->magic != BACKUP_MAP_MAGIC) ||
+        trailer->length == 0 || (trailer->length % 16) != 0 ||
+        trailer->length > slot_size - sizeof(fw_backup_trailer_t))
+        return NULL;
+
+    return trailer;
+}
 
-    if (sys->Flash_Erase(dest_addr, slot_size) != 0) {
-        sys->EnableIRQ();
+/* A backup this long still leaves room for the blank map and the trailer */
+static uint8_t BL_Backup_Has_Map(uint32_t backup_len) {
+    return backup_len <= sys->mem.slot_size - sizeof(fw_backup_trailer_t) - sizeof(fw_backup_map_t);
+}
+
+/**
+ * @brief  Reads the blank map in front of the backup trailer.
+ * @retval Pointer to the map in Flash, or NULL if the backup has none.
+ */
+static const fw_backup_map_t *BL_Find_Backup_Map(uint32_t slot_addr) {
+    const fw_backup_trailer_t *trailer = BL_Find_Backup_Trailer(slot_addr);
+
+    if (trailer == NULL || trailer->magic != BACKUP_MAP_MAGIC || !BL_Backup_Has_Map(trailer->length))
+        return NULL;
+
+    return (const fw_backup_map_t *)trailer - 1;
+}
+
+/**
+ * @brief  Hashes the plaintext of the backup in a slot without writing it
+ *         anywhere. Blocks marked in the map count as erased (0xFF).
+ * @retval 1 on success, 0 on a crypto error.
+ */
+static uint8_t BL_Backup_Digest(uint32_t slot_addr, const fw_backup_trailer_t *trailer,
+                                const fw_backup_map_t *map, uint8_t digest[32]) {
+    uint8_t plain[BL_CRYPTO_CHUNK];
+    uint8_t iv[16];
+    const uint8_t *chacha_iv = trailer->nonce ? iv : NULL;
+    BL_HashCtx_t hash;
+
+    BL_Backup_Iv(trailer->nonce, iv);
+    if (!BL_Backup_Key(chacha_iv) || sys->crypto.SHA256_Init(&hash) != 0)
         return 0;
+
+    for (uint32_t i = 0, n; i < trailer->length; i += n) {
+        n = trailer->length - i;
+        if (n > BL_CRYPTO_CHUNK) n = BL_CRYPTO_CHUNK;
+
+        if (BL_Map_Blank(map, i / FW_BACKUP_BLOCK_SIZE))
+            memset(plain, 0xFF, n);
+        else if (BL_Backup_Crypt(0, chacha_iv, i, (const uint8_t *)(slot_addr + i), plain, n) != 0)
+            return 0;
+
+        if (sys->crypto.SHA256_Update(&hash, plain, n) != 0)
+            return 0;
     }
+    return sys->crypto.SHA256_Final(&hash, digest) == 0;
+}
 
-    for (uint32_t offset = 0; offset < slot_size; offset += 16) {
-        memcpy(buffer_enc, (void *)(src_addr + offset), 16);
+/**
+ * @brief  Reads the mirror trailer of the scratch slot and checks the image
+ *         it describes against its digest.
+ * @retval Pointer to the trailer in Flash, or NULL if scratch holds no copy.
+ */
+static const fw_mirror_trailer_t *BL_Find_Mirror(void) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    const fw_mirror_trailer_t *mirror =
+        (const fw_mirror_trailer_t *)(mem->scratch_addr + mem->slot_size - sizeof(fw_mirror_trailer_t));
+    uint8_t digest[32];
 
-        if (sys->crypto.AES_DecryptBlock(AES_SECRET_KEY, buffer_enc, buffer_dec) != 0) {
-            sys->EnableIRQ();
+    if (mirror->magic != MIRROR_MAGIC || mirror->length == 0 || (mirror->length % 16) != 0 ||
+        mirror->length > mem->slot_size - sizeof(fw_mirror_trailer_t))
+        return NULL;
+
+    if (sys->crypto.SHA256((const uint8_t *)mem->scratch_addr, mirror->length, digest) != 0 ||
+        memcmp(digest, mirror->digest, sizeof(digest)) != 0)
+        return NULL;
+
+    return mirror;
+}
+
+/* ========================================================================== */
+/* SWAP ENGINE                                                                */
+/* ========================================================================== */
+
+/*
+ * Installs and rollbacks move the images in units of swap.unit_size bytes
+ * (one erase sector of the slots). Each unit takes three steps:
+ *
+ *   STAGE   new image unit  -> scratch   (decrypt the package or the backup)
+ *   BACKUP  active unit     -> S6 unit   (encrypt; STAGE already consumed that part of S6)
+ *   INSTALL scratch         -> active unit
+ *
+ * swap.steps_done is saved in the config sector after every step. A step
+ * only reads data that no earlier step has overwritten, so after a reset
+ * the first unfinished step is simply run again. Units past both images
+ * are never touched. The ChaCha20 IV sits in S6 unit 0, so it is kept
+ * in swap.stage_iv.
+ *
+ * An overwrite install (BL_SWAP_OVERWRITE) is one unit that starts at
+ * INSTALL, which decrypts S6 straight into S5. S6 is never written, so
+ * a reset simply runs INSTALL again.
+ */
+
+enum { SWAP_STAGE, SWAP_BACKUP, SWAP_INSTALL, SWAP_STEPS };
+
+static const char *const update_steps[SWAP_STEPS] = {
+    "Decrypting S6 -> S7", "Backing up S5 -> S6", "Installing S7 -> S5"
+};
+
+static const char *const ram_steps[SWAP_STEPS] = {
+    "Decrypting S6 -> RAM", "Backing up S5 -> S6", "Installing RAM -> S5"
+};
+
+static const char *const rollback_steps[SWAP_STEPS] = {
+    "Decrypting Backup (S6 -> S7)", "Backing up Current App (S5 -> S6)", "Restoring Old App (S7 -> S5)"
+};
+
+static const char *BL_Step_Label(const BL_SwapProgress_t *p, uint32_t step) {
+    if (p->flags & BL_SWAP_OVERWRITE)
+        return "Installing S6 -> S5 (no backup)";
+    if (p->flags & BL_SWAP_DIRECT)
+        return "Restoring Old App (S6 -> S5)";
+    if (p->flags & BL_SWAP_ROLLBACK)
+        return rollback_steps[step];
+    return (p->flags & BL_SWAP_RAM) ? ram_steps[step] : update_steps[step];
+}
+
+/* LZ4 streams need the whole output in one piece, so they use a single unit */
+static uint32_t BL_Swap_Unit_Size(uint32_t flags) {
+    uint32_t sector = sys->mem.sector_size;
+
+    if (sector == 0 || (flags & FW_FLAG_LZ4) || (sys->mem.slot_size % sector) != 0)
+        return sys->mem.slot_size;
+    return sector;
+}
+
+static uint32_t BL_Swap_Units(const BL_SwapProgress_t *p) {
+    uint32_t install = BL_ALIGN16(p->image_size);
+    uint32_t span    = (install > p->backup_len) ? install : p->backup_len;
+    return (span + p->unit_size - 1) / p->unit_size;
+}
+
+/*
+ * Nonce for a ChaCha20 backup: the sequence number of the config record
+ * that starts the swap. A backup that leaves no room for the trailer has
+ * nowhere to keep it and stays AES-ECB.
+ */
+static uint32_t BL_Backup_Nonce(const BL_SwapProgress_t *p) {
+    if (!BL_BACKUP_CHACHA20 || p->backup_len > sys->mem.slot_size - sizeof(fw_backup_trailer_t))
+        return 0;
+    BL_ConfigFlash_t flash = BL_Config_Flash();
+    return BL_Config_Next_Seq(&flash);
+}
+
+/*
+ * RAM an update staged in the RAM window takes: the decrypt pass writes
+ * data_len bytes, INSTALL copies the 16-byte aligned image.
+ */
+static uint32_t BL_Ram_Need(const BL_SwapProgress_t *p) {
+    uint32_t len = (p->data_len > p->image_size) ? p->data_len : p->image_size;
+    return BL_ALIGN16(len);
+}
+
+/*
+ * Stages the update in RAM when it fits the window and takes one unit:
+ * the RAM copy is lost on reset, so INSTALL must be the only step left
+ * once S6 has been overwritten (see BL_Ram_Resume()).
+ */
+static uint8_t BL_Ram_Stage_Fits(const BL_SwapProgress_t *p) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    return mem->ram_stage_size != 0 && p->unit_size == mem->slot_size &&
+           BL_Ram_Need(p) <= mem->ram_stage_size;
+}
+
+/* Installs without backup, by build option or as the signed header asks */
+static uint8_t BL_Overwrite_Only(uint32_t flags) {
+    return BL_OVERWRITE_ONLY || (flags & FW_FLAG_OVERWRITE);
+}
+
+/* Where STAGE puts the new image; an overwrite install decrypts into S5 */
+static uint32_t BL_Stage_Addr(const BL_SwapProgress_t *p) {
+    if (p->flags & BL_SWAP_OVERWRITE)
+        return sys->mem.app_active_addr;
+    return (p->flags & BL_SWAP_RAM) ? sys->mem.ram_stage_addr : sys->mem.scratch_addr;
+}
+
+/* Clears the staged image after a failed check */
+static void BL_Stage_Wipe(const BL_SwapProgress_t *p) {
+    if (p->flags & BL_SWAP_RAM)
+        memset((void *)sys->mem.ram_stage_addr, 0xFF, sys->mem.ram_stage_size);
+    else
+        sys->Flash_Erase(sys->mem.scratch_addr, sys->mem.slot_size);
+}
+
+/* Part of [0, len) that falls into the given unit */
+static uint32_t BL_Unit_Bytes(const BL_SwapProgress_t *p, uint32_t len, uint32_t unit) {
+    uint32_t start = unit * p->unit_size;
+
+    if (len <= start)
+        return 0;
+    return (len - start < p->unit_size) ? len - start : p->unit_size;
+}
+
+/**
+ * @brief  STAGE step: writes one unit of the new image into the scratch slot
+ *         (or RAM, or S5 for an overwrite install).
+ * @param  auth If not NULL, checks run on the ciphertext as it is decrypted
+ *              (single-unit updates only, see BL_Decrypt_Run).
+ * @retval 1 on success, 0 on failure. stage_bad_data tells an LZ4 stream
+ *         that does not decode from an erase or program error.
+ */
+static uint8_t BL_Swap_Stage(const BL_SwapProgress_t *p, uint32_t unit, const BL_StageAuth_t *auth) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    uint32_t offset = unit * p->unit_size;
+    uint32_t dest   = BL_Stage_Addr(p);
+
+    stage_bad_data = 0;
+    if (p->flags & BL_SWAP_RAM)
+        memset((void *)dest, 0xFF, BL_Ram_Need(p));
+    else if (!BL_Erase_Area(dest, p->unit_size))
+        return 0;
+
+    if (p->flags & BL_SWAP_ROLLBACK) {
+        /* The trailer and map sit in the last unit, which no BACKUP step has reached yet */
+        const uint8_t *chacha_iv = (p->flags & FW_FLAG_CHACHA20) ? p->stage_iv : NULL;
+        return BL_Backup_Run(mem->app_download_addr + offset, mem->scratch_addr,
+                             BL_Unit_Bytes(p, p->image_size, unit), 0, chacha_iv, offset,
+                             BL_Find_Backup_Map(mem->app_download_addr));
+    }
+
+    uint32_t src    = mem->app_download_addr + p->data_offset + offset;
+    uint32_t length = BL_Unit_Bytes(p, p->data_len, unit);
+    uint8_t  lz4    = (p->flags & FW_FLAG_LZ4) ? 1 : 0;
+
+    uint32_t start = sys->GetTick();
+    BL_Writer_Init(&writer, (p->flags & BL_SWAP_RAM) ? NULL : sys);
+    if (lz4)
+        BL_Lz4_Init(&lz4_stream, &writer, dest, p->image_size);
+    BL_Flash_Begin();
+
+    uint8_t ok = BL_Decrypt_Run(src, dest, length, p, offset,
+                                auth, lz4 ? &lz4_stream : NULL);
+
+    BL_Writer_Flush(&writer);
+    BL_Flash_End();
+
+    if (!ok)
+        return 0;
+
+    if (writer.fail_addr != 0) {
+        printf("FAILED! Write Error at offset %d.\r\n", (int)(writer.fail_addr - dest));
+        return 0;
+    }
+
+    if (lz4) {
+        if (!BL_Lz4_Done(&lz4_stream)) {
+            printf("FAILED! Decompression Error after %d bytes.\r\n", (int)lz4_stream.produced);
+            stage_bad_data = 1;
             return 0;
         }
+        printf("  [DEBUG] LZ4: %d -> %d bytes\r\n", (int)length, (int)p->image_size);
+    }
 
-        if (sys->Flash_Write(dest_addr + offset, buffer_dec, 16) != 0) {
-            sys->EnableIRQ();
+    BL_Report_Rate(lz4 ? p->image_size : length, start);
+    return 1;
+}
+
+static uint8_t BL_Swap_Step(const BL_SwapProgress_t *p, uint32_t unit, uint32_t step) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    uint32_t offset = unit * p->unit_size;
+    uint32_t length;
+    uint8_t  iv[16];
+    fw_backup_map_t blank;
+
+    switch (step) {
+        case SWAP_STAGE:
+            return BL_Swap_Stage(p, unit, NULL);
+
+        case SWAP_BACKUP:
+            length = BL_Unit_Bytes(p, p->backup_len, unit);
+            if (!BL_Erase_Area(mem->app_download_addr + offset, p->unit_size))
+                return 0;
+            printf("  [DEBUG] Encrypting & Backing up %d bytes... \r\n", (int)length);
+            BL_Backup_Iv(p->backup_nonce, iv);
+
+            /* Erased blocks stay erased in S6; BL_Swap_Finalize records them */
+            memset(&blank, 0, sizeof(blank));
+            if (BL_Backup_Has_Map(p->backup_len))
+                BL_Map_Scan(mem->app_active_addr, offset, length, &blank);
+            return BL_Backup_Run(mem->app_active_addr + offset, mem->app_download_addr + offset,
+                                 length, 1, p->backup_nonce ? iv : NULL, offset, &blank);
+
+        case SWAP_INSTALL:
+            if (p->flags & BL_SWAP_OVERWRITE)
+                return BL_Swap_Stage(p, unit, NULL);
+            length = BL_Unit_Bytes(p, BL_ALIGN16(p->image_size), unit);
+            if (!BL_Erase_Area(mem->app_active_addr + offset, p->unit_size))
+                return 0;
+            if (length == 0)
+                return 1;
+            if (p->flags & BL_SWAP_DIRECT) {
+                /* This swap never writes S6, so the backup stays readable until the end */
+                const uint8_t *chacha_iv = (p->flags & FW_FLAG_CHACHA20) ? p->stage_iv : NULL;
+                return BL_Backup_Run(mem->app_download_addr + offset, mem->app_active_addr + offset,
+                                     length, 0, chacha_iv, offset,
+                                     BL_Find_Backup_Map(mem->app_download_addr));
+            }
+            return BL_Raw_Copy(BL_Stage_Addr(p), mem->app_active_addr + offset, length);
+
+        default:
             return 0;
-        }
     }
+}
 
-    sys->EnableIRQ();
+/**
+ * @brief  Clears S6 past the backup and writes the blank map, digest and
+ *         backup trailer.
+ * @details The rest of S6 may still hold the tail of the package. Safe to
+ *          repeat if a reset hits while it runs.
+ */
+static uint8_t BL_Swap_Finalize(const BootConfig_t *cfg) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    const BL_SwapProgress_t *p = &cfg->swap;
+    uint32_t used = BL_Swap_Units(p) * p->unit_size;
+
+    /* S6 holds no backup: the kept image, or the installed package itself */
+    if (p->flags & (BL_SWAP_KEPT | BL_SWAP_OVERWRITE))
+        return 1;
+
+    if (used < mem->slot_size && !BL_Is_Erased(mem->app_download_addr + used, mem->slot_size - used)) {
+        if (sys->Flash_Erase(mem->app_download_addr + used, mem->slot_size - used) != 0)
+            return 0;
+    }
+
+    if (p->backup_len > mem->slot_size - sizeof(fw_backup_trailer_t))
+        return 1;
+
+    /* Map and trailer are written together, the map first */
+    struct {
+        fw_backup_map_t     map;
+        fw_backup_trailer_t trailer;
+    } tail = { { { 0 }, { 0 } }, { p->backup_len, cfg->current_version, p->backup_nonce, BACKUP_MAGIC } };
+    uint32_t size = sizeof(tail.trailer);
+
+    if (BL_Backup_Has_Map(p->backup_len)) {
+        /* The blocks the BACKUP steps left out are the erased ones in S6 */
+        BL_Map_Scan(mem->app_download_addr, 0, p->backup_len, &tail.map);
+        if (!BL_Backup_Digest(mem->app_download_addr, &tail.trailer, &tail.map, tail.map.digest))
+            return 0;
+        tail.trailer.magic = BACKUP_MAP_MAGIC;
+        size = sizeof(tail);
+    }
+
+    uint32_t tail_addr = mem->app_download_addr + mem->slot_size - size;
+    const uint8_t *data = (const uint8_t *)&tail + sizeof(tail) - size;
+
+    if (memcmp((void *)tail_addr, data, size) == 0)
+        return 1;
+
+    BL_Flash_Begin();
+    int ret = sys->Flash_Write(tail_addr, data, size);
+    BL_Flash_End();
+    return ret == 0;
+}
+
+/**
+ * @brief  Runs the remaining steps of the swap in cfg->swap, then commits
+ *         the new image to the config.
+ * @retval 1 on success, 0 on failure (progress is kept for a retry).
+ */
+static uint8_t BL_Swap_Run(BootConfig_t *cfg) {
+    BL_SwapProgress_t *p = &cfg->swap;
+    uint32_t units = BL_Swap_Units(p);
+
+    while (p->steps_done < units * SWAP_STEPS) {
+        uint32_t unit = p->steps_done / SWAP_STEPS;
+        uint32_t step = p->steps_done % SWAP_STEPS;
+
+        printf("[%d/%d] %s (unit %d/%d)...\r\n", (int)(step + 1), SWAP_STEPS,
+               BL_Step_Label(p, step), (int)(unit + 1), (int)units);
+
+        if (!BL_Swap_Step(p, unit, step))
+            return 0;
+
+        p->steps_done++;
+        BL_WriteConfig(cfg);
+    }
+
+    if (!BL_Swap_Finalize(cfg))
+        return 0;
+
+    cfg->system_status   = STATE_NORMAL;
+    cfg->current_version = p->image_version;
+    cfg->current_size    = p->image_size;
+    memset(p, 0, sizeof(*p));
+    BL_WriteConfig(cfg);
     return 1;
 }
 
+/**
+ * @brief  Stages the first unit of an update while hashing the ciphertext,
+ *         then checks the signature over that hash.
+ * @details Replaces a separate Firmware_Is_Valid() pass over S6 when the
+ *          update fits in one unit. Only the scratch slot is written, so
+ *          nothing is committed before the ECDSA check passes; on failure
+ *          the scratch slot is wiped.
+ * @param  footer Copy of the footer found in S6.
+ * @param  p      Swap description of the update (single unit).
+ * @retval BL_OK, a verification error (BL_ERR_HASH_FAIL for an LZ4 stream
+ *         that does not decode, which stops the hash), or BL_ERR_FLASH_FAIL.
+ */
+static FW_Status_t BL_Stage_Verified_Update(const fw_footer_t *footer, const BL_SwapProgress_t *p) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    BL_HashCtx_t hash;
+    BL_StageAuth_t auth = { &hash, NULL, NULL };
+    uint8_t digest[32];
+
+    /* CBC needs whole blocks; the stream ciphers only footer alignment */
+    uint32_t align = (p->flags & FW_FLAGS_CIPHER) ? 4 : 16;
+
+    if (footer->size > mem->slot_size || footer->size < 32 || (footer->size % align) != 0)
+        return BL_ERR_IMAGE_SIZE_BAD;
+
+    FW_Status_t status = Firmware_Check_Header(mem->app_download_addr, mem->slot_size);
+    if (status != BL_OK)
+        return status;
+
+    if (sys->crypto.SHA256_Init(&hash) != 0 ||
+        sys->crypto.SHA256_Update(&hash, (uint8_t *)mem->app_download_addr, p->data_offset) != 0)
+        return BL_ERR_HASH_FAIL;
+
+    if (!BL_Swap_Stage(p, 0, &auth)) {
+        if (!stage_bad_data)
+            return BL_ERR_FLASH_FAIL;
+        BL_Stage_Wipe(p);
+        return BL_ERR_HASH_FAIL;
+    }
+
+    if (sys->crypto.SHA256_Final(&hash, digest) != 0)
+        return BL_ERR_HASH_FAIL;
+
+    status = Firmware_Verify_Digest(digest, footer, &sys->crypto);
+    if (status != BL_OK) {
+        BL_Stage_Wipe(p);
+        return status;
+    }
+
+    printf("  [DEBUG] Verified in the decrypt pass, %u bytes of S6 not re-read\r\n",
+           (unsigned int)footer->size);
+    return BL_OK;
+}
+
+/*
+ * FW_FLAG_AEAD packages (RFC 8439 ChaCha20-Poly1305). The one-time
+ * Poly1305 key is ChaCha20 block 0 of the package nonce, the header is
+ * the associated data and the ciphertext starts at block 1. The tag sits
+ * in S6 right after the ciphertext, followed by the signed SHA-256 of the
+ * ciphertext, which is hashed in the same pass.
+ */
+static uint8_t BL_Aead_Begin(const BL_SwapProgress_t *p, BL_PolyCtx_t *poly, BL_HashCtx_t *hash) {
+    static const uint8_t zero[32] = { 0 };
+    uint8_t poly_key[32];
+    uint32_t counter;
+    int ret;
+
+    memcpy(&counter, p->stage_iv + 12, 4);
+    if (counter != 1 || !BL_Chacha_Key() || sys->crypto.SHA256_Init(hash) != 0)
+        return 0;
+
+    ret = sys->crypto.CHACHA20_Xor(chacha_key, p->stage_iv, 0, zero, poly_key, 32);
+    if (ret == 0)
+        ret = sys->crypto.POLY1305_Init(poly, poly_key);
+    memset(poly_key, 0, sizeof(poly_key));
+
+    if (ret != 0 || sys->crypto.POLY1305_Update(poly, (const uint8_t *)sys->mem.app_download_addr,
+                                                sizeof(fw_header_t)) != 0)
+        return 0;
+    return 1;
+}
+
+/*
+ * Pads, appends the lengths and compares with the tag in S6, then compares
+ * the ciphertext digest with the signed one after the tag
+ */
+static FW_Status_t BL_Aead_Finish(const BL_SwapProgress_t *p, BL_PolyCtx_t *poly, BL_HashCtx_t *hash) {
+    static const uint8_t zero[16] = { 0 };
+    const uint8_t *stored = (const uint8_t *)(sys->mem.app_download_addr + p->data_offset + p->data_len);
+    uint64_t lengths[2] = { sizeof(fw_header_t), p->data_len };
+    uint8_t tag[FW_AEAD_TAG_SIZE];
+    uint8_t digest[FW_AEAD_DIGEST_SIZE];
+    uint8_t diff = 0;
+
+    if (sys->crypto.POLY1305_Update(poly, zero, (16 - p->data_len % 16) % 16) != 0 ||
+        sys->crypto.POLY1305_Update(poly, (const uint8_t *)lengths, sizeof(lengths)) != 0 ||
+        sys->crypto.POLY1305_Final(poly, tag) != 0 ||
+        sys->crypto.SHA256_Final(hash, digest) != 0)
+        return BL_ERR_HASH_FAIL;
+
+    for (uint32_t i = 0; i < FW_AEAD_TAG_SIZE; i++)
+        diff |= tag[i] ^ stored[i];
+    if (diff)
+        return BL_ERR_TAG_FAIL;
+
+    /* A tag forged with the device key still has to match the signed digest */
+    return memcmp(digest, stored + FW_AEAD_TAG_SIZE, sizeof(digest)) ? BL_ERR_DIGEST_FAIL : BL_OK;
+}
+
+/**
+ * @brief  Authenticates the ciphertext of an FW_FLAG_AEAD package.
+ * @details With stage set (single-unit update) unit 0 is decrypted into the
+ *          scratch slot in the same pass, and wiped again if the tag does
+ *          not match. Otherwise S6 is only read, before the swap starts
+ *          overwriting it. A stage that fails (e.g. an LZ4 error) is
+ *          followed by a plain MAC pass, so forged data still reads as
+ *          BL_ERR_TAG_FAIL.
+ * @param  p     Swap description of the update.
+ * @param  stage 1 to stage unit 0 while authenticating.
+ * @retval BL_OK, BL_ERR_TAG_FAIL, BL_ERR_DIGEST_FAIL, BL_ERR_HASH_FAIL
+ *         (also for LZ4 data that does not decode), or BL_ERR_FLASH_FAIL
+ *         if tag and digest matched but staging failed on flash.
+ */
+static FW_Status_t BL_Aead_Verify(const BL_SwapProgress_t *p, uint8_t stage) {
+    const uint8_t *data = (const uint8_t *)(sys->mem.app_download_addr + p->data_offset);
+    BL_PolyCtx_t poly;
+    BL_HashCtx_t hash;
+    BL_StageAuth_t auth = { &hash, &poly, NULL };
+    uint8_t staged = 0;
+
+    if (!BL_Aead_Begin(p, &poly, &hash))
+        return BL_ERR_HASH_FAIL;
+
+    if (stage) {
+        staged = BL_Swap_Stage(p, 0, &auth);
+        if (!staged && !BL_Aead_Begin(p, &poly, &hash))
+            return BL_ERR_HASH_FAIL;
+    }
+
+    /* MAC and hash each piece while it is at hand, as the stage pass does */
+    for (uint32_t i = 0; !staged && i < p->data_len; i += BL_CRYPTO_CHUNK) {
+        uint32_t n = (p->data_len - i < BL_CRYPTO_CHUNK) ? p->data_len - i : BL_CRYPTO_CHUNK;
+
+        if (sys->crypto.POLY1305_Update(&poly, data + i, n) != 0 ||
+            sys->crypto.SHA256_Update(&hash, data + i, n) != 0)
+            return BL_ERR_HASH_FAIL;
+    }
+
+    FW_Status_t status = BL_Aead_Finish(p, &poly, &hash);
+    if (status != BL_OK) {
+        if (stage)
+            BL_Stage_Wipe(p);
+        return status;
+    }
+
+    if (stage && !staged) {
+        if (!stage_bad_data)
+            return BL_ERR_FLASH_FAIL;
+        BL_Stage_Wipe(p);
+        return BL_ERR_HASH_FAIL;
+    }
+    return BL_OK;
+}
+
+/* Digest of the first chunk of an FW_FLAG_CHUNKED package, in S6 after the data */
+static const uint8_t *BL_Chunk_Digests(const BL_SwapProgress_t *p) {
+    return (const uint8_t *)(sys->mem.app_download_addr + p->data_offset + p->data_len);
+}
+
+/* Hashes the chunks of S6 in order and stops at the first mismatch */
+static FW_Status_t BL_Chunks_Check(const BL_SwapProgress_t *p) {
+    const uint8_t *src = (const uint8_t *)(sys->mem.app_download_addr + p->data_offset);
+    const uint8_t *expected = BL_Chunk_Digests(p);
+    uint8_t digest[32];
+
+    for (uint32_t i = 0; i < p->data_len; i += FW_CHUNK_SIZE) {
+        uint32_t n = (p->data_len - i < FW_CHUNK_SIZE) ? p->data_len - i : FW_CHUNK_SIZE;
+
+        if (sys->crypto.SHA256(src + i, n, digest) != 0)
+            return BL_ERR_HASH_FAIL;
+        if (memcmp(digest, expected, FW_CHUNK_DIGEST_SIZE) != 0) {
+            printf("FAILED! Chunk %d digest mismatch.\r\n", (int)(i / FW_CHUNK_SIZE));
+            return BL_ERR_CHUNK_FAIL;
+        }
+        expected += FW_CHUNK_DIGEST_SIZE;
+    }
+    return BL_OK;
+}
+
+/**
+ * @brief  Checks the ciphertext of an FW_FLAG_CHUNKED package against its
+ *         signed chunk digests.
+ * @details With stage set (single-unit update) each chunk is checked just
+ *          before it is decrypted into the scratch slot, so staging stops at
+ *          the first bad chunk and S7 only ever holds checked data. Otherwise S6 is only read, before the swap
+ *          starts overwriting it (and the digests at its end). A stage that
+ *          fails for another reason is followed by a plain check pass, so a
+ *          bad chunk still reads as BL_ERR_CHUNK_FAIL.
+ * @param  p     Swap description of the update.
+ * @param  stage 1 to stage unit 0 while checking.
+ * @retval BL_OK, BL_ERR_CHUNK_FAIL, BL_ERR_HASH_FAIL (also for LZ4 data
+ *         that does not decode), or BL_ERR_FLASH_FAIL if every chunk
+ *         matched but staging failed on flash.
+ */
+static FW_Status_t BL_Chunks_Verify(const BL_SwapProgress_t *p, uint8_t stage) {
+    BL_StageAuth_t auth = { NULL, NULL, BL_Chunk_Digests(p) };
+
+    if (stage && BL_Swap_Stage(p, 0, &auth))
+        return BL_OK;
+
+    uint8_t bad_data = stage_bad_data;
+    FW_Status_t status = BL_Chunks_Check(p);
+    if (!stage || status != BL_OK)
+        return status;
+    if (!bad_data)
+        return BL_ERR_FLASH_FAIL;
+    BL_Stage_Wipe(p);
+    return BL_ERR_HASH_FAIL;
+}
+
 /* ========================================================================== */
 /* FIRMWARE UPDATE & ROLLBACK                                                 */
 /* ========================================================================== */
 
-void BL_Swap_NoBuffer(void) {
-    BootConfig_t cfg;
+/**
+ * @brief  Drops a package that failed its checks: S6 is erased, the swap
+ *         forgotten and the state set back to NORMAL.
+ */
+static void BL_Reject_Update(BootConfig_t *cfg, FW_Status_t status) {
     const BL_MemoryMap_t *mem = &sys->mem;
 
-    BL_ReadConfig(&cfg);
+    printf("FAIL! Error Code: %d\r\n", status);
+
+    sys->Flash_Erase(mem->app_download_addr, mem->slot_size);
+
+    if (status == BL_ERR_SIG_FAIL)
+        printf("Reason: ECDSA Signature Mismatch.\r\n");
+    if (status == BL_ERR_FOOTER_NOT_FOUND)
+        printf("Reason: Footer Missing.\r\n");
+    if (status == BL_ERR_IMAGE_SIZE_BAD)
+        printf("Reason: Image Size Out of Range.\r\n");
+    if (status == BL_ERR_HASH_FAIL)
+        printf("Reason: Payload Could Not Be Hashed or Decompressed.\r\n");
+    if (status == BL_ERR_TAG_FAIL)
+        printf("Reason: Poly1305 Tag Mismatch.\r\n");
+    if (status == BL_ERR_CHUNK_FAIL)
+        printf("Reason: Chunk Digest Mismatch.\r\n");
+    if (status == BL_ERR_DIGEST_FAIL)
+        printf("Reason: Ciphertext Digest Mismatch.\r\n");
+
+    memset(&cfg->swap, 0, sizeof(cfg->swap));
+    cfg->system_status = STATE_NORMAL;
+    BL_WriteConfig(cfg);
+}
+
+/**
+ * @brief  Verifies the package in S6 and records the swap that installs it.
+ *         The signature is checked here only, once per install: by the
+ *         fused stage when it runs, by Firmware_Verify() otherwise.
+ * @param  footer_addr Footer already found in S6 this boot, or 0.
+ * @retval 1 if the swap is recorded and ready to run, 0 otherwise.
+ */
+static uint8_t BL_Prepare_Update(BootConfig_t *cfg, uint32_t footer_addr) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    BL_SwapProgress_t *p = &cfg->swap;
 
-    uint32_t footer_addr = Find_Footer_Address(mem->app_download_addr, mem->slot_size);
+    if (footer_addr == 0)
+        footer_addr = Find_Footer_Address(mem->app_download_addr, mem->slot_size);
     if (footer_addr == 0) {
         printf("Error: No Footer found in S6.\r\n");
-        cfg.system_status = STATE_NORMAL;
-        BL_WriteConfig(&cfg);
-        return;
+        cfg->system_status = STATE_NORMAL;
+        BL_WriteConfig(cfg);
+        return 0;
     }
 
     fw_footer_t footer;
     memcpy(&footer, (void *)footer_addr, sizeof(fw_footer_t));
 
-    printf("[BL] Verifying Signature... ");
-    FW_Status_t status = Firmware_Is_Valid(mem->app_download_addr, mem->slot_size, &sys->crypto);
+    /* Everything the swap needs from S6, which it overwrites as it goes */
+    const fw_header_t *header = Find_Header(mem->app_download_addr, mem->slot_size);
+    p->magic         = SWAP_MAGIC;
+    p->flags         = header ? header->flags : 0;
+    p->steps_done    = 0;
+    p->unit_size     = BL_Swap_Unit_Size(p->flags);
+    p->data_offset   = (header ? sizeof(fw_header_t) : 0) + 16;
+    p->data_len      = footer.size - p->data_offset - Firmware_Manifest_Size(header, footer.size);
+    p->image_size    = header ? header->image_size : p->data_len;
+    p->image_version = footer.version;
+    p->backup_len    = BL_Backup_Length(cfg);
+    p->backup_nonce  = BL_Backup_Nonce(p);
+    memcpy(p->stage_iv, (void *)(mem->app_download_addr + p->data_offset - 16), 16);
+    if (BL_Overwrite_Only(p->flags)) {
+        /* One INSTALL pass over the whole slot, nothing backed up */
+        p->flags        |= BL_SWAP_OVERWRITE;
+        p->unit_size     = mem->slot_size;
+        p->backup_len    = 0;
+        p->backup_nonce  = 0;
+    } else if (BL_Ram_Stage_Fits(p)) {
+        p->flags |= BL_SWAP_RAM;
+    }
 
-    if (status != BL_OK) {
-        printf("FAIL! Error Code: %d\r\n", status);
+    /* Staging while verifying needs a scratch copy, which an overwrite install skips */
+    uint8_t fused = BL_FUSED_VERIFY && p->unit_size == mem->slot_size &&
+                    !(p->flags & BL_SWAP_OVERWRITE);
 
-        sys->Flash_Erase(mem->app_download_addr, mem->slot_size);
+    FW_Status_t status;
+    FW_Verify_t result;
 
-        if (status == BL_ERR_SIG_FAIL)
-            printf("Reason: ECDSA Signature Mismatch.\r\n");
-        if (status == BL_ERR_FOOTER_NOT_FOUND)
-            printf("Reason: Footer Missing.\r\n");
+    if (p->flags & (FW_FLAG_AEAD | FW_FLAG_CHUNKED)) {
+        /* The signature covers the manifest only; the data is checked here every time */
+        uint8_t stage = fused;
 
-        cfg.system_status = STATE_NORMAL;
-        BL_WriteConfig(&cfg);
-        return;
+        printf("[BL] Verifying Signature... ");
+        status = Firmware_Verify(mem->app_download_addr, mem->slot_size, &sys->crypto, &result);
+
+        if (status == BL_OK) {
+            printf("OK!\r\n");
+            if (stage)
+                printf("[1/3] Decrypting + Authenticating S6 -> %s...\r\n",
+                       (p->flags & BL_SWAP_RAM) ? "RAM" : "S7");
+            else
+                printf("[BL] Authenticating S6... ");
+            status = (p->flags & FW_FLAG_AEAD) ? BL_Aead_Verify(p, stage)
+                                               : BL_Chunks_Verify(p, stage);
+
+            if (status == BL_ERR_FLASH_FAIL) {
+                printf("Error: Decryption Failed.\r\n");
+                return 0;
+            }
+            if (stage && status == BL_OK)
+                p->steps_done = 1;
+        }
+    } else if (fused) {
+        printf("[1/3] Decrypting + Verifying S6 -> %s...\r\n", (p->flags & BL_SWAP_RAM) ? "RAM" : "S7");
+        status = BL_Stage_Verified_Update(&footer, p);
+
+        if (status == BL_ERR_FLASH_FAIL) {
+            printf("Error: Decryption Failed.\r\n");
+            return 0;
+        }
+        p->steps_done = 1;
+    } else {
+        printf("[BL] Verifying Signature... ");
+        status = Firmware_Verify(mem->app_download_addr, mem->slot_size, &sys->crypto, &result);
+    }
+
+    if (status != BL_OK) {
+        BL_Reject_Update(cfg, status);
+        return 0;
     }
     printf("OK!\r\n");
     printf("[BL] Valid Update! Ver: %d, Payload: %d\r\n",
            (int)footer.version, (int)footer.size);
 
-    printf("[1/3] Decrypting S6 -> S7...\r\n");
-    if (!BL_Decrypt_Update_Image(mem->app_download_addr, mem->scratch_addr, footer.size)) {
-        printf("Error: Decryption Failed.\r\n");
-        return;
-    }
+    /* S6 is fully checked and stays untouched: only INSTALL is left */
+    if (p->flags & BL_SWAP_OVERWRITE)
+        p->steps_done = SWAP_INSTALL;
 
-    printf("[2/3] Backing up S5 -> S6...\r\n");
-    if (!BL_Encrypt_Backup(mem->app_active_addr, mem->app_download_addr)) {
-        printf("Error: Backup Failed.\r\n");
-        return;
+    /* From here on a reset resumes the swap */
+    cfg->system_status = STATE_UPDATE_REQ;
+    BL_WriteConfig(cfg);
+    return 1;
+}
+
+/**
+ * @brief  Records a rollback without BACKUP steps when a copy of the image
+ *         in S5 already exists, as it does when toggling between two images:
+ *          - scratch still holds the S5 image (left there by the last swap):
+ *            it becomes the rollback copy and the backup is decrypted
+ *            straight into S5 (BL_SWAP_DIRECT);
+ *          - the S6 backup is the S5 image and scratch holds the other one:
+ *            scratch is installed and S6 stays the rollback copy.
+ *         Only S5 is written. The images are compared by SHA-256, which
+ *         reads flash only. Needs single-unit slots: a smaller scratch
+ *         cannot hold a whole image.
+ * @retval 1 if such a swap is recorded, 0 to run the full rollback.
+ */
+static uint8_t BL_Prepare_Kept(BootConfig_t *cfg) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    BL_SwapProgress_t *p = &cfg->swap;
+    const fw_backup_trailer_t *trailer = BL_Find_Backup_Trailer(mem->app_download_addr);
+    const fw_backup_map_t *map = BL_Find_Backup_Map(mem->app_download_addr);
+    uint32_t active_len = BL_Backup_Length(cfg);
+    uint8_t active[32], backup[32], scratch[32];
+
+    if (map == NULL || BL_Swap_Unit_Size(0) != mem->slot_size ||
+        active_len > mem->slot_size - sizeof(fw_mirror_trailer_t))
+        return 0;
+
+    printf("[BL] Comparing image digests... ");
+    if (sys->crypto.SHA256((const uint8_t *)mem->app_active_addr, active_len, active) != 0 ||
+        !BL_Backup_Digest(mem->app_download_addr, trailer, map, backup) ||
+        memcmp(backup, map->digest, sizeof(backup)) != 0) {
+        printf("backup unchecked.\r\n");
+        return 0;
     }
 
-    printf("[3/3] Installing S7 -> S5...\r\n");
-    if (!BL_Raw_Copy(mem->scratch_addr, mem->app_active_addr, mem->slot_size)) {
-        printf("Error: Installation Failed.\r\n");
-        return;
+    if (trailer->length == active_len && memcmp(backup, active, sizeof(active)) == 0) {
+        /* S6 already holds the image being displaced */
+        const fw_mirror_trailer_t *mirror = BL_Find_Mirror();
+
+        if (mirror == NULL ||
+            (mirror->length == active_len && memcmp(mirror->digest, active, sizeof(active)) == 0)) {
+            printf("no other image stored.\r\n");
+            return 0;
+        }
+        printf("S6 backup matches S5, installing S7 copy.\r\n");
+
+        memset(p, 0, sizeof(*p));
+        p->flags         = BL_SWAP_ROLLBACK | BL_SWAP_KEPT;
+        p->image_size    = mirror->length;
+        p->image_version = mirror->version;
+    } else {
+        fw_mirror_trailer_t tail = { { 0 }, active_len, cfg->current_version, 0xFFFFFFFF, MIRROR_MAGIC };
+        uint32_t tail_addr = mem->scratch_addr + mem->slot_size - sizeof(tail);
+        uint8_t  written;
+
+        memcpy(tail.digest, active, sizeof(active));
+        written = memcmp((void *)tail_addr, &tail, sizeof(tail)) == 0;
+
+        if (sys->crypto.SHA256((const uint8_t *)mem->scratch_addr, active_len, scratch) != 0 ||
+            memcmp(scratch, active, sizeof(active)) != 0 ||
+            (!written && !BL_Is_Erased(tail_addr, sizeof(tail)))) {
+            printf("no copy of S5.\r\n");
+            return 0;
+        }
+        printf("S7 matches S5, keeping it as the backup.\r\n");
+
+        /* S7 must describe itself before the swap that overwrites S5 is recorded */
+        if (!written) {
+            BL_Flash_Begin();
+            int ret = sys->Flash_Write(tail_addr, (const uint8_t *)&tail, sizeof(tail));
+            BL_Flash_End();
+            if (ret != 0)
+                return 0;
+        }
+
+        memset(p, 0, sizeof(*p));
+        p->flags         = BL_SWAP_ROLLBACK | BL_SWAP_KEPT | BL_SWAP_DIRECT |
+                           (trailer->nonce ? FW_FLAG_CHACHA20 : 0);
+        p->image_size    = trailer->length;
+        p->image_version = trailer->version;
+        BL_Backup_Iv(trailer->nonce, p->stage_iv);
     }
 
-    printf("[BL] Update Successful! Setting State to NORMAL.\r\n");
-    cfg.system_status   = STATE_NORMAL;
-    cfg.current_version = footer.version;
-    BL_WriteConfig(&cfg);
+    p->magic      = SWAP_MAGIC;
+    p->steps_done = SWAP_INSTALL;
+    p->unit_size  = mem->slot_size;
 
-    printf("Swap Complete. Resetting...\r\n");
-    sys->SystemReset();
+    /* From here on a reset resumes the swap */
+    cfg->system_status = STATE_ROLLBACK;
+    BL_WriteConfig(cfg);
+    return 1;
 }
 
-uint8_t BL_Rollback(void) {
-    BootConfig_t cfg;
+/**
+ * @brief  Checks the backup in S6 and records the swap that restores it.
+ * @retval BL_OK if the swap is recorded and ready to run, else an error code.
+ */
+static uint8_t BL_Prepare_Rollback(BootConfig_t *cfg) {
     const BL_MemoryMap_t *mem = &sys->mem;
+    BL_SwapProgress_t *p = &cfg->swap;
 
-    BL_ReadConfig(&cfg);
+    if (BL_Prepare_Kept(cfg))
+        return BL_OK;
 
-    printf("\r\n[BL] Starting Rollback/Toggle...\r\n");
+    /* Copy the trailer out now: the backup steps overwrite the backup slot */
+    const fw_backup_trailer_t *trailer = BL_Find_Backup_Trailer(mem->app_download_addr);
+    p->magic         = SWAP_MAGIC;
+    p->flags         = BL_SWAP_ROLLBACK | ((trailer && trailer->nonce) ? FW_FLAG_CHACHA20 : 0);
+    p->steps_done    = 0;
+    p->unit_size     = BL_Swap_Unit_Size(0);
+    p->image_size    = trailer ? trailer->length  : mem->slot_size;
+    p->image_version = trailer ? trailer->version : cfg->current_version;
+    p->backup_len    = BL_Backup_Length(cfg);
+    p->data_offset   = 0;
+    p->data_len      = 0;
+    p->backup_nonce  = BL_Backup_Nonce(p);
+    BL_Backup_Iv(trailer ? trailer->nonce : 0, p->stage_iv);
 
-    printf("[1/3] Decrypting Backup (S6 -> S7)...\r\n");
-    if (!BL_Decrypt_Backup_Image(mem->app_download_addr, mem->scratch_addr)) {
+    printf("[1/3] %s (unit 1/%d)...\r\n", rollback_steps[SWAP_STAGE], (int)BL_Swap_Units(p));
+    if (!BL_Swap_Stage(p, 0, NULL)) {
         printf("Error: Rollback Decryption Failed.\r\n");
         return 1;
     }
@@ -289,26 +1326,220 @@ uint8_t BL_Rollback(void) {
         printf("[ERROR] Reset Vector: 0x%08X. Aborting Swap to protect Active App.\r\n",
                (unsigned int)resetVector);
 
-        cfg.system_status = STATE_NORMAL;
-        BL_WriteConfig(&cfg);
+        memset(p, 0, sizeof(*p));
+        cfg->system_status = STATE_NORMAL;
+        BL_WriteConfig(cfg);
         return 2;
     }
 
-    printf("[2/3] Backing up Current App (S5 -> S6)...\r\n");
-    if (!BL_Encrypt_Backup(mem->app_active_addr, mem->app_download_addr)) {
-        printf("Error: Backup Failed.\r\n");
-        return 3;
+    /* From here on a reset resumes the swap */
+    p->steps_done      = 1;
+    cfg->system_status = STATE_ROLLBACK;
+    BL_WriteConfig(cfg);
+    return BL_OK;
+}
+
+/**
+ * @brief  Picks up a RAM-staged update after a reset, which lost the staged image.
+ * @details Until the BACKUP step completes S5 is untouched: the swap is
+ *          dropped and the package, if S6 still holds it, is prepared again.
+ *          After it, S6 holds the backup instead of the package, so the swap
+ *          becomes a rollback that decrypts the backup straight back into S5
+ *          (run after the next reset). The update must then be sent again.
+ * @retval 1 to go on with the update, 0 to stop here.
+ */
+static uint8_t BL_Ram_Resume(BootConfig_t *cfg) {
+    BL_SwapProgress_t *p = &cfg->swap;
+
+    /* Past INSTALL only the commit is left */
+    if (p->steps_done > SWAP_INSTALL)
+        return 1;
+
+    if (p->steps_done < SWAP_INSTALL) {
+        printf("[BL] Staged image lost before the backup completed. Starting over.\r\n");
+        memset(p, 0, sizeof(*p));
+        BL_WriteConfig(cfg);
+        return 1;
+    }
+
+    printf("[BL] Staged image lost during install. Restoring the backup.\r\n");
+
+    /* The restore reads the blank map and trailer */
+    if (!BL_Swap_Finalize(cfg))
+        return 0;
+
+    uint32_t nonce = p->backup_nonce;
+    uint32_t len   = p->backup_len;
+    uint32_t unit  = p->unit_size;
+
+    memset(p, 0, sizeof(*p));
+    p->magic         = SWAP_MAGIC;
+    p->flags         = BL_SWAP_ROLLBACK | BL_SWAP_KEPT | BL_SWAP_DIRECT | (nonce ? FW_FLAG_CHACHA20 : 0);
+    p->steps_done    = SWAP_INSTALL;
+    p->unit_size     = unit;
+    p->image_size    = len;
+    p->image_version = cfg->current_version;
+    BL_Backup_Iv(nonce, p->stage_iv);
+
+    cfg->system_status = STATE_ROLLBACK;
+    BL_WriteConfig(cfg);
+    return 0;
+}
+
+void BL_Swap_NoBuffer(uint32_t footer_addr) {
+    BootConfig_t cfg;
+
+    BL_ReadConfig(&cfg);
+
+    if (BL_Swap_Pending(&cfg) && (cfg.swap.flags & BL_SWAP_RAM) && !BL_Ram_Resume(&cfg))
+        return;
+
+    if (BL_Swap_Pending(&cfg) && !(cfg.swap.flags & BL_SWAP_ROLLBACK)) {
+        printf("[BL] Resuming interrupted update at step %d.\r\n", (int)(cfg.swap.steps_done + 1));
+    } else if (!BL_Prepare_Update(&cfg, footer_addr)) {
+        return;
+    }
+
+    if (!BL_Swap_Run(&cfg)) {
+        printf("Error: Swap Failed at step %d.\r\n", (int)(cfg.swap.steps_done + 1));
+
+        /* A package that does not decode fails every retry; S5 is still untouched */
+        if (stage_bad_data && cfg.swap.steps_done == 0) {
+            BL_Stage_Wipe(&cfg.swap);
+            BL_Reject_Update(&cfg, BL_ERR_HASH_FAIL);
+        }
+        return;
+    }
+
+    printf("[BL] Update Successful! Setting State to NORMAL.\r\n");
+    printf("Swap Complete. Resetting...\r\n");
+    sys->SystemReset();
+}
+
+uint8_t BL_Rollback(void) {
+    BootConfig_t cfg;
+
+    BL_ReadConfig(&cfg);
+
+    printf("\r\n[BL] Starting Rollback/Toggle...\r\n");
+
+    if (BL_Swap_Pending(&cfg) && (cfg.swap.flags & BL_SWAP_ROLLBACK)) {
+        printf("[BL] Resuming interrupted rollback at step %d.\r\n", (int)(cfg.swap.steps_done + 1));
+    } else if (BL_OVERWRITE_ONLY) {
+        printf("[BL] Overwrite-only build keeps no backup. Send the firmware again.\r\n");
+        return 2;
+    } else {
+        uint8_t ret = BL_Prepare_Rollback(&cfg);
+        if (ret != BL_OK)
+            return ret;
     }
 
-    printf("[3/3] Restoring Old App (S7 -> S5)...\r\n");
-    if (!BL_Raw_Copy(mem->scratch_addr, mem->app_active_addr, mem->slot_size)) {
-        printf("Error: Installation Failed.\r\n");
-        return 4;
+    if (!BL_Swap_Run(&cfg)) {
+        printf("Error: Rollback Failed at step %d.\r\n", (int)(cfg.swap.steps_done + 1));
+        return 3;
     }
 
     printf("[BL] Rollback Successful! Resetting...\r\n");
-    cfg.system_status = STATE_NORMAL;
-    BL_WriteConfig(&cfg);
     sys->SystemReset();
     return BL_OK;
 }
+
+/* ========================================================================== */
+/* IN-PLACE A/B SLOTS (BL_XIP_AB)                                             */
+/* ========================================================================== */
+
+#if BL_XIP_AB
+
+static uint32_t BL_Xip_Other(uint32_t slot) {
+    return slot == sys->mem.app_active_addr ? sys->mem.app_download_addr : sys->mem.app_active_addr;
+}
+
+/* The image's reset handler lies in the slot it runs from */
+static uint8_t BL_Xip_Vector_Ok(uint32_t slot) {
+    uint32_t entry = *(const uint32_t *)(slot + 4);
+    return entry > slot && entry < slot + sys->mem.slot_size;
+}
+
+/**
+ * @brief  Checks that a slot holds a signed image linked to run from it.
+ * @details An XIP image is plaintext with no header, and the footer follows
+ *          it directly. The signature covers the footer.size bytes at the
+ *          slot start and the footer's version and size words after them,
+ *          since the slot is picked by version. An image linked for the
+ *          other slot, or an encrypted package, fails the vector check.
+ */
+static FW_Status_t BL_Xip_Check(uint32_t slot, FW_Verify_t *result) {
+    memset(result, 0, sizeof(*result));
+
+    result->footer_addr = Firmware_Locate(slot, sys->mem.slot_size);
+    if (result->footer_addr == 0)
+        return result->status = BL_ERR_FOOTER_NOT_FOUND;
+    memcpy(&result->footer, (const void *)result->footer_addr, sizeof(fw_footer_t));
+
+    if (Find_Header(slot, sys->mem.slot_size) != NULL || !BL_Xip_Vector_Ok(slot))
+        return result->status = BL_ERR_VECTOR_BAD;
+
+    if (sys->crypto.SHA256((uint8_t *)slot, result->footer.size + offsetof(fw_footer_t, signature),
+                           result->digest) != 0)
+        return result->status = BL_ERR_HASH_FAIL;
+    result->has_digest = 1;
+
+    return result->status = Firmware_Verify_Digest(result->digest, &result->footer, &sys->crypto);
+}
+
+uint32_t BL_Xip_Select(BootConfig_t *cfg, uint32_t state) {
+    const BL_MemoryMap_t *mem = &sys->mem;
+    FW_Verify_t check[2];
+    const FW_Verify_t *picked = NULL;
+    uint32_t slot = (cfg->xip.magic == XIP_MAGIC) ? cfg->xip.boot_slot : 0;
+
+    if ((slot != mem->app_active_addr && slot != mem->app_download_addr) || !BL_Xip_Vector_Ok(slot)) {
+        /* Nothing selected yet, or the slot was erased: run the newest valid image */
+        printf("[BL] No slot selected. Checking both slots...\r\n");
+        FW_Status_t a = BL_Xip_Check(mem->app_active_addr, &check[0]);
+        FW_Status_t b = BL_Xip_Check(mem->app_download_addr, &check[1]);
+        printf("  S5: %d, S6: %d\r\n", (int)a, (int)b);
+
+        if (a == BL_OK && (b != BL_OK || check[0].footer.version >= check[1].footer.version)) {
+            slot   = mem->app_active_addr;
+            picked = &check[0];
+        } else if (b == BL_OK) {
+            slot   = mem->app_download_addr;
+            picked = &check[1];
+        } else {
+            return 0;
+        }
+    } else if (state == STATE_UPDATE_REQ || state == STATE_ROLLBACK) {
+        /* The running slot stays trusted; only the other one is checked */
+        uint32_t other = BL_Xip_Other(slot);
+        FW_Status_t status = BL_Xip_Check(other, &check[0]);
+        uint8_t newer = status == BL_OK && check[0].footer.version > cfg->current_version;
+
+        printf("[BL] Slot 0x%X: status %d, version 0x%X (running 0x%X).\r\n",
+               (unsigned int)other, (int)status,
+               (unsigned int)check[0].footer.version, (unsigned int)cfg->current_version);
+
+        if (newer || (status == BL_OK && state == STATE_ROLLBACK)) {
+            printf("[BL] %s: switching to 0x%X.\r\n", newer ? "Update" : "Rollback",
+                   (unsigned int)other);
+            slot   = other;
+            picked = &check[0];
+        } else {
+            printf("[BL] No %s image. Keeping 0x%X.\r\n",
+                   state == STATE_UPDATE_REQ ? "newer" : "valid", (unsigned int)slot);
+        }
+    }
+
+    /* Flipping the pointer is the whole update or rollback */
+    if (picked) {
+        cfg->xip.magic       = XIP_MAGIC;
+        cfg->xip.boot_slot   = slot;
+        cfg->current_version = picked->footer.version;
+        cfg->current_size    = picked->footer.size;
+    }
+    cfg->system_status = STATE_NORMAL;
+    BL_WriteConfig(cfg);
+    return slot;
+}
+
+#endif /* BL_XIP_AB */
@@ -0,0 +1,90 @@
+/**
+ * @file    BL_Lz4Stream.c
+ * @brief   Streaming LZ4 decompression of update payloads into flash.
+ * @details Payload layout (after decryption):
+ *          [u32 len][len bytes LZ4 block] ... [PKCS7 padding]
+ * Each block expands to FW_LZ4_BLOCK_SIZE bytes (the last one to the
+ * remainder of image_size) and may reference up to 64 KB of earlier
+ * output. That history is read straight back from flash, so only one
+ * block has to be held in RAM.
+ *
+ * Return convention: 0 = success, -1 = error.
+ */
+
+#include "BL_Lz4Stream.h"
+
+#define LZ4_HISTORY  (64U * 1024U)
+
+void BL_Lz4_Init(BL_Lz4Stream_t *z, BL_FlashWriter_t *out,
+                 uint32_t dest_addr, uint32_t image_size) {
+    z->out        = out;
+    z->dest_addr  = dest_addr;
+    z->produced   = 0;
+    z->image_size = image_size;
+    z->have       = 0;
+    z->error      = 0;
+}
+
+static int BL_Lz4_Block(BL_Lz4Stream_t *z, uint32_t comp_len) {
+    uint32_t expect = z->image_size - z->produced;
+    if (expect > FW_LZ4_BLOCK_SIZE)
+        expect = FW_LZ4_BLOCK_SIZE;
+
+    /* History must be in flash before it can be used as a dictionary */
+    if (BL_Writer_Flush(z->out) != 0)
+        return -1;
+
+    uint32_t dict_size = (z->produced < LZ4_HISTORY) ? z->produced : LZ4_HISTORY;
+    const char *dict   = (const char *)(z->dest_addr + z->produced - dict_size);
+
+    int n = LZ4_decompress_safe_usingDict((const char *)&z->rec[4], (char *)z->block,
+                                          (int)comp_len, (int)expect,
+                                          dict, (int)dict_size);
+    if (n < 0 || (uint32_t)n != expect)
+        return -1;
+
+    if (BL_Writer_Put(z->out, z->dest_addr + z->produced, z->block, expect) != 0)
+        return -1;
+
+    z->produced += expect;
+    return 0;
+}
+
+int BL_Lz4_Put(BL_Lz4Stream_t *z, const uint8_t *data, uint32_t length) {
+    /* Anything after the last block is cipher padding and is ignored */
+    while (length > 0 && !z->error && z->produced < z->image_size) {
+        uint32_t want = 4;
+
+        if (z->have >= 4) {
+            uint32_t comp_len = (uint32_t)z->rec[0] | ((uint32_t)z->rec[1] << 8) |
+                                ((uint32_t)z->rec[2] << 16) | ((uint32_t)z->rec[3] << 24);
+            if (comp_len == 0 || comp_len > BL_LZ4_RECORD_MAX - 4) {
+                z->error = 1;
+                break;
+            }
+            want += comp_len;
+        }
+
+        uint32_t n = want - z->have;
+        if (n > length)
+            n = length;
+
+        for (uint32_t i = 0; i < n; i++)
+            z->rec[z->have + i] = data[i];
+        z->have += n;
+        data    += n;
+        length  -= n;
+
+        if (want > 4 && z->have == want) {
+            if (BL_Lz4_Block(z, want - 4) != 0)
+                z->error = 1;
+            z->have = 0;
+        }
+    }
+
+    return z->error ? -1 : 0;
+}
+
+int BL_Lz4_Done(const BL_Lz4Stream_t *z) {
+    return !z->error && z->produced == z->image_size;
+}
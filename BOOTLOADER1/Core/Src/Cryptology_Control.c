@@ -8,17 +8,52 @@
 #include "Cryptology_Control.h"
 #include "firmware_footer.h"
 #include "keys.h"
+#include <string.h>
 
 extern const uint8_t ECDSA_public_key_xy[];
 
 /**
- * @brief  Scans the Flash slot backwards to locate the Firmware Footer.
+ * @brief  Returns the package header at the start of a slot, if present.
+ * @details The header is only trusted as a pointer: its footer_offset must
+ *          stay inside the slot and land on a footer whose size matches.
+ *          The contents are authenticated later, as part of the payload.
+ * @param  slot_start Start address of the Flash sector/slot.
+ * @param  slot_size  Size of the slot in bytes.
+ * @retval Pointer to the header in Flash, or NULL for legacy images.
+ */
+const fw_header_t *Find_Header(uint32_t slot_start, uint32_t slot_size)
+{
+    const fw_header_t *header = (const fw_header_t *)slot_start;
+
+    if (header->magic != HEADER_MAGIC)
+        return 0;
+
+    if ((header->footer_offset % 4) != 0 ||
+        header->footer_offset < sizeof(fw_header_t) ||
+        header->footer_offset > slot_size - sizeof(fw_footer_t))
+        return 0;
+
+    const fw_footer_t *footer = (const fw_footer_t *)(slot_start + header->footer_offset);
+    if (footer->magic != FOOTER_MAGIC || footer->size != header->footer_offset)
+        return 0;
+
+    return header;
+}
+
+/**
+ * @brief  Locates the Firmware Footer in a slot.
+ * @details Packages with a header are resolved in two reads. Legacy images
+ *          fall back to scanning the slot backwards for FOOTER_MAGIC.
  * @param  slot_start Start address of the Flash sector/slot.
  * @param  slot_size  Size of the slot in bytes.
  * @retval Address of the fw_footer_t structure, or 0 if not found.
  */
 uint32_t Find_Footer_Address(uint32_t slot_start, uint32_t slot_size)
 {
+    const fw_header_t *header = Find_Header(slot_start, slot_size);
+    if (header)
+        return slot_start + header->footer_offset;
+
     uint32_t slot_end = slot_start + slot_size;
 
     for (uint32_t addr = slot_end - 4; addr >= slot_start; addr -= 4)
@@ -33,6 +68,72 @@ uint32_t Find_Footer_Address(uint32_t slot_start, uint32_t slot_size)
     return 0;
 }
 
+/**
+ * @brief  Rejects packages this bootloader cannot install.
+ * @param  slot_start Start address of the Flash sector/slot.
+ * @param  slot_size  Size of the slot in bytes.
+ * @retval BL_OK (also for legacy images), or BL_ERR_FOOTER_BAD /
+ *         BL_ERR_IMAGE_SIZE_BAD for unknown flags or an image that is
+ *         oversized or too short for a vector table.
+ */
+FW_Status_t Firmware_Check_Header(uint32_t slot_start, uint32_t slot_size)
+{
+    const fw_header_t *header = Find_Header(slot_start, slot_size);
+    if (header == 0)
+        return BL_OK;
+
+    if (header->flags & ~FW_FLAGS_SUPPORTED)
+        return BL_ERR_FOOTER_BAD;
+
+    /* At most one cipher flag; none means AES-128-CBC */
+    if ((header->flags & FW_FLAGS_CIPHER) == FW_FLAGS_CIPHER)
+        return BL_ERR_FOOTER_BAD;
+
+    /* AEAD is ChaCha20-Poly1305 only, and needs room for IV, tag and digest */
+    if ((header->flags & FW_FLAG_AEAD) &&
+        (!(header->flags & FW_FLAG_CHACHA20) ||
+         header->footer_offset < sizeof(fw_header_t) + 16 + FW_AEAD_TAG_SIZE + FW_AEAD_DIGEST_SIZE))
+        return BL_ERR_FOOTER_BAD;
+
+    /* Chunk digests replace the tag, and need at least one chunk */
+    if ((header->flags & FW_FLAG_CHUNKED) &&
+        ((header->flags & FW_FLAG_AEAD) ||
+         header->footer_offset <= sizeof(fw_header_t) + 16 + FW_CHUNK_DIGEST_SIZE))
+        return BL_ERR_FOOTER_BAD;
+
+    /* The image starts with the initial SP and reset handler */
+    if (header->image_size < 2 * sizeof(uint32_t) || header->image_size > slot_size)
+        return BL_ERR_IMAGE_SIZE_BAD;
+
+    return BL_OK;
+}
+
+/**
+ * @brief  Finds an update package in a slot without hashing it.
+ * @details The footer must directly follow the payload it signs and the
+ *          header must pass Firmware_Check_Header(), so backup ciphertext
+ *          that happens to hold FOOTER_MAGIC is not taken for a package.
+ *          The signature is left to the install, which checks it once.
+ * @param  slot_start Start address of the Flash sector/slot.
+ * @param  slot_size  Size of the slot in bytes.
+ * @retval Address of the fw_footer_t structure, or 0 if there is no package.
+ */
+uint32_t Firmware_Locate(uint32_t slot_start, uint32_t slot_size)
+{
+    uint32_t footer_addr = Find_Footer_Address(slot_start, slot_size);
+    if (footer_addr == 0)
+        return 0;
+
+    const fw_footer_t *footer = (const fw_footer_t *)footer_addr;
+    if (footer->size > slot_size || footer_addr != slot_start + footer->size)
+        return 0;
+
+    if (Firmware_Check_Header(slot_start, slot_size) != BL_OK)
+        return 0;
+
+    return footer_addr;
+}
+
 /**
  * @brief  Validates the integrity and authenticity of a firmware image.
  * @param  start_addr Start address of the image in Flash.
@@ -43,21 +144,114 @@ uint32_t Find_Footer_Address(uint32_t slot_start, uint32_t slot_size)
 FW_Status_t Firmware_Is_Valid(uint32_t start_addr, uint32_t slot_size,
                               const BL_CryptoOps_t *crypto)
 {
-    uint32_t footer_addr = Find_Footer_Address(start_addr, slot_size);
-    if (footer_addr == 0)
-        return BL_ERR_FOOTER_NOT_FOUND;
+    FW_Verify_t result;
+    return Firmware_Verify(start_addr, slot_size, crypto, &result);
+}
 
-    fw_footer_t *footer = (fw_footer_t *)footer_addr;
+/**
+ * @brief  Firmware_Is_Valid(), keeping what the check found.
+ * @param  start_addr Start address of the image in Flash.
+ * @param  slot_size  Maximum size of the slot.
+ * @param  crypto     Pointer to the crypto operations (SHA-256, ECDSA).
+ * @param  result     Filled with the status, footer and payload digest.
+ * @retval result->status.
+ */
+FW_Status_t Firmware_Verify(uint32_t start_addr, uint32_t slot_size,
+                            const BL_CryptoOps_t *crypto, FW_Verify_t *result)
+{
+    memset(result, 0, sizeof(*result));
 
-    if (footer->size > slot_size)
-        return BL_ERR_IMAGE_SIZE_BAD;
+    result->footer_addr = Find_Footer_Address(start_addr, slot_size);
+    if (result->footer_addr == 0)
+        return result->status = BL_ERR_FOOTER_NOT_FOUND;
 
-    /* Hash the payload */
-    uint8_t digest[32];
-    if (crypto->SHA256((uint8_t *)start_addr, footer->size, digest) != 0)
-        return BL_ERR_HASH_FAIL;
+    memcpy(&result->footer, (const void *)result->footer_addr, sizeof(fw_footer_t));
 
-    /* Verify ECDSA signature */
+    if (result->footer.size > slot_size)
+        return result->status = BL_ERR_IMAGE_SIZE_BAD;
+
+    result->status = Firmware_Check_Header(start_addr, slot_size);
+    if (result->status != BL_OK)
+        return result->status;
+
+    const fw_header_t *header = Find_Header(start_addr, slot_size);
+    if (Firmware_Manifest_Size(header, result->footer.size) != 0) {
+        /* Only the manifest is signed; its digests cover the ciphertext */
+        if (Firmware_Manifest_Digest(start_addr, &result->footer, crypto, result->digest) != 0)
+            return result->status = BL_ERR_HASH_FAIL;
+    } else if (crypto->SHA256((uint8_t *)start_addr, result->footer.size, result->digest) != 0) {
+        /* Hash the payload */
+        return result->status = BL_ERR_HASH_FAIL;
+    }
+    result->has_digest = 1;
+
+    return result->status = Firmware_Verify_Digest(result->digest, &result->footer, crypto);
+}
+
+/**
+ * @brief  Size of the manifest between the ciphertext and the footer.
+ * @param  header       Package header, or NULL for a legacy image.
+ * @param  payload_size footer.size of the package.
+ * @retval The tag and ciphertext digest for FW_FLAG_AEAD, the digest list for
+ *         FW_FLAG_CHUNKED, 0 when the signature covers the whole payload.
+ */
+uint32_t Firmware_Manifest_Size(const fw_header_t *header, uint32_t payload_size)
+{
+    if (header == 0)
+        return 0;
+
+    if (header->flags & FW_FLAG_AEAD)
+        return FW_AEAD_TAG_SIZE + FW_AEAD_DIGEST_SIZE;
+
+    if (header->flags & FW_FLAG_CHUNKED) {
+        /* Every chunk takes FW_CHUNK_SIZE + FW_CHUNK_DIGEST_SIZE, the last may be short */
+        uint32_t step  = FW_CHUNK_SIZE + FW_CHUNK_DIGEST_SIZE;
+        uint32_t total = payload_size - sizeof(fw_header_t) - 16;
+        return ((total + step - 1) / step) * FW_CHUNK_DIGEST_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  Computes the signed manifest of an FW_FLAG_AEAD or FW_FLAG_CHUNKED package.
+ * @details SHA-256 over the header, the IV field and the Poly1305 tag and
+ *          ciphertext digest, or the chunk digests, just before the footer:
+ *          80 bytes for AEAD, 32 more per 4 KB chunk for a chunked package.
+ * @param  start_addr Start address of the package in Flash (with a header).
+ * @param  footer     Footer of the package (size locates the manifest).
+ * @param  crypto     Pointer to the crypto operations.
+ * @param  digest     Receives the manifest digest.
+ * @retval 0 on success, -1 on a hash error.
+ */
+int Firmware_Manifest_Digest(uint32_t start_addr, const fw_footer_t *footer,
+                             const BL_CryptoOps_t *crypto, uint8_t digest[32])
+{
+    BL_HashCtx_t hash;
+    uint32_t size = Firmware_Manifest_Size((const fw_header_t *)start_addr, footer->size);
+    const uint8_t *manifest = (const uint8_t *)(start_addr + footer->size - size);
+
+    if (crypto->SHA256_Init(&hash) != 0 ||
+        crypto->SHA256_Update(&hash, (const uint8_t *)start_addr, sizeof(fw_header_t) + 16) != 0 ||
+        crypto->SHA256_Update(&hash, manifest, size) != 0 ||
+        crypto->SHA256_Final(&hash, digest) != 0)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * @brief  Checks the footer signature against an already computed digest.
+ * @details Lets callers that hashed the payload in another pass (e.g. while
+ *          decrypting it) skip a second read of the slot.
+ * @param  digest SHA-256 of the payload (footer->size bytes).
+ * @param  footer Footer holding the signature.
+ * @param  crypto Pointer to the crypto operations.
+ * @retval BL_OK or BL_ERR_SIG_FAIL.
+ */
+FW_Status_t Firmware_Verify_Digest(const uint8_t digest[32], const fw_footer_t *footer,
+                                   const BL_CryptoOps_t *crypto)
+{
     if (crypto->ECDSA_Verify(ECDSA_public_key_xy, digest, 32, footer->signature) != 0)
         return BL_ERR_SIG_FAIL;
 
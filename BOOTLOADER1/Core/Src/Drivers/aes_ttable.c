@@ -0,0 +1,184 @@
+/*
+ * aes_ttable.c
+ *
+ * AES-128 with 32-bit round tables. Each round does SubBytes, ShiftRows,
+ * MixColumns and AddRoundKey as 16 table lookups and XORs on column
+ * words, where TinyCrypt works byte by byte and multiplies in GF(2^8)
+ * for every (Inv)MixColumns.
+ *
+ * Decryption uses the equivalent inverse cipher (FIPS-197 5.3.5): the
+ * middle round keys are run through InvMixColumns once at key setup, so
+ * both directions have the same round structure.
+ *
+ * The S-boxes and tables (2.5 KB) are computed into RAM on first use
+ * rather than stored in flash. On the F7 that is DTCM, which has no
+ * cache, so lookup time does not depend on the index.
+ *
+ * Column words are little-endian: byte 0 of a column is bits 0-7.
+ */
+
+#include "aes_ttable.h"
+
+#define ROTL(x, n)  (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROTL8(x, n) ((uint8_t)(((x) << (n)) | ((x) >> (8 - (n)))))
+
+static uint8_t  sbox[256];
+static uint8_t  inv_sbox[256];
+static uint32_t te[256];   /* MixColumns column of S(x):    2 1 1 3    */
+static uint32_t td[256];   /* InvMixColumns column of S'(x): 14 9 13 11 */
+static uint8_t  tables_ready = 0;
+
+static uint8_t AES_TT_XTime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+}
+
+static uint32_t AES_TT_Load(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void AES_TT_Store(uint8_t *p, uint32_t w) {
+    p[0] = (uint8_t)w;
+    p[1] = (uint8_t)(w >> 8);
+    p[2] = (uint8_t)(w >> 16);
+    p[3] = (uint8_t)(w >> 24);
+}
+
+static void AES_TT_Build_Tables(void) {
+    uint8_t p = 1, q = 1;
+
+    /* p walks GF(2^8)* by multiplying with 3, q = 1/p by dividing by 3 */
+    do {
+        p = (uint8_t)(p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0x00));
+        q ^= (uint8_t)(q << 1);
+        q ^= (uint8_t)(q << 2);
+        q ^= (uint8_t)(q << 4);
+        if (q & 0x80)
+            q ^= 0x09;
+
+        sbox[p] = (uint8_t)(q ^ ROTL8(q, 1) ^ ROTL8(q, 2) ^ ROTL8(q, 3) ^ ROTL8(q, 4) ^ 0x63);
+    } while (p != 1);
+    sbox[0] = 0x63;
+
+    for (uint32_t i = 0; i < 256; i++)
+        inv_sbox[sbox[i]] = (uint8_t)i;
+
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t s  = sbox[i];
+        uint32_t s2 = AES_TT_XTime((uint8_t)s);
+        te[i] = s2 | (s << 8) | (s << 16) | ((s2 ^ s) << 24);
+
+        uint32_t y  = inv_sbox[i];
+        uint32_t y2 = AES_TT_XTime((uint8_t)y);
+        uint32_t y4 = AES_TT_XTime((uint8_t)y2);
+        uint32_t y8 = AES_TT_XTime((uint8_t)y4);
+        td[i] = (y8 ^ y4 ^ y2) | ((y8 ^ y) << 8) | ((y8 ^ y4 ^ y) << 16) | ((y8 ^ y2 ^ y) << 24);
+    }
+
+    tables_ready = 1;
+}
+
+static uint32_t AES_TT_SubWord(uint32_t w) {
+    return (uint32_t)sbox[w & 0xFF] | ((uint32_t)sbox[(w >> 8) & 0xFF] << 8) |
+           ((uint32_t)sbox[(w >> 16) & 0xFF] << 16) | ((uint32_t)sbox[w >> 24] << 24);
+}
+
+/* InvMixColumns of a round key word: td[sbox[b]] is InvMixColumns of (b,0,0,0) */
+static uint32_t AES_TT_InvMix(uint32_t w) {
+    return td[sbox[w & 0xFF]] ^ ROTL(td[sbox[(w >> 8) & 0xFF]], 8) ^
+           ROTL(td[sbox[(w >> 16) & 0xFF]], 16) ^ ROTL(td[sbox[w >> 24]], 24);
+}
+
+void AES_TT_SetKey(AES_TT_Key_t *key, const uint8_t raw[16]) {
+    uint8_t rcon = 0x01;
+
+    if (!tables_ready)
+        AES_TT_Build_Tables();
+
+    for (int i = 0; i < 4; i++)
+        key->ek[i] = AES_TT_Load(raw + 4 * i);
+
+    for (int i = 4; i < 44; i++) {
+        uint32_t t = key->ek[i - 1];
+        if ((i % 4) == 0) {
+            t = AES_TT_SubWord(ROTL(t, 24)) ^ rcon;
+            rcon = AES_TT_XTime(rcon);
+        }
+        key->ek[i] = key->ek[i - 4] ^ t;
+    }
+
+    /* Decryption keys: reverse round order, InvMixColumns on rounds 1-9 */
+    for (int j = 0; j < 4; j++) {
+        key->dk[j]      = key->ek[40 + j];
+        key->dk[40 + j] = key->ek[j];
+    }
+    for (int r = 1; r < 10; r++) {
+        for (int j = 0; j < 4; j++)
+            key->dk[4 * r + j] = AES_TT_InvMix(key->ek[4 * (10 - r) + j]);
+    }
+}
+
+void AES_TT_Encrypt(const AES_TT_Key_t *key, const uint8_t in[16], uint8_t out[16]) {
+    const uint32_t *rk = key->ek;
+    uint32_t s0 = AES_TT_Load(in)      ^ rk[0];
+    uint32_t s1 = AES_TT_Load(in + 4)  ^ rk[1];
+    uint32_t s2 = AES_TT_Load(in + 8)  ^ rk[2];
+    uint32_t s3 = AES_TT_Load(in + 12) ^ rk[3];
+    uint32_t t0, t1, t2, t3;
+
+    for (int r = 1; r < 10; r++) {
+        rk += 4;
+        t0 = te[s0 & 0xFF] ^ ROTL(te[(s1 >> 8) & 0xFF], 8) ^
+             ROTL(te[(s2 >> 16) & 0xFF], 16) ^ ROTL(te[s3 >> 24], 24) ^ rk[0];
+        t1 = te[s1 & 0xFF] ^ ROTL(te[(s2 >> 8) & 0xFF], 8) ^
+             ROTL(te[(s3 >> 16) & 0xFF], 16) ^ ROTL(te[s0 >> 24], 24) ^ rk[1];
+        t2 = te[s2 & 0xFF] ^ ROTL(te[(s3 >> 8) & 0xFF], 8) ^
+             ROTL(te[(s0 >> 16) & 0xFF], 16) ^ ROTL(te[s1 >> 24], 24) ^ rk[2];
+        t3 = te[s3 & 0xFF] ^ ROTL(te[(s0 >> 8) & 0xFF], 8) ^
+             ROTL(te[(s1 >> 16) & 0xFF], 16) ^ ROTL(te[s2 >> 24], 24) ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    /* Last round has no MixColumns */
+    rk += 4;
+    AES_TT_Store(out, ((uint32_t)sbox[s0 & 0xFF] | ((uint32_t)sbox[(s1 >> 8) & 0xFF] << 8) |
+                       ((uint32_t)sbox[(s2 >> 16) & 0xFF] << 16) | ((uint32_t)sbox[s3 >> 24] << 24)) ^ rk[0]);
+    AES_TT_Store(out + 4, ((uint32_t)sbox[s1 & 0xFF] | ((uint32_t)sbox[(s2 >> 8) & 0xFF] << 8) |
+                           ((uint32_t)sbox[(s3 >> 16) & 0xFF] << 16) | ((uint32_t)sbox[s0 >> 24] << 24)) ^ rk[1]);
+    AES_TT_Store(out + 8, ((uint32_t)sbox[s2 & 0xFF] | ((uint32_t)sbox[(s3 >> 8) & 0xFF] << 8) |
+                           ((uint32_t)sbox[(s0 >> 16) & 0xFF] << 16) | ((uint32_t)sbox[s1 >> 24] << 24)) ^ rk[2]);
+    AES_TT_Store(out + 12, ((uint32_t)sbox[s3 & 0xFF] | ((uint32_t)sbox[(s0 >> 8) & 0xFF] << 8) |
+                            ((uint32_t)sbox[(s1 >> 16) & 0xFF] << 16) | ((uint32_t)sbox[s2 >> 24] << 24)) ^ rk[3]);
+}
+
+void AES_TT_Decrypt(const AES_TT_Key_t *key, const uint8_t in[16], uint8_t out[16]) {
+    const uint32_t *rk = key->dk;
+    uint32_t s0 = AES_TT_Load(in)      ^ rk[0];
+    uint32_t s1 = AES_TT_Load(in + 4)  ^ rk[1];
+    uint32_t s2 = AES_TT_Load(in + 8)  ^ rk[2];
+    uint32_t s3 = AES_TT_Load(in + 12) ^ rk[3];
+    uint32_t t0, t1, t2, t3;
+
+    /* InvShiftRows takes row r of column c from column c - r */
+    for (int r = 1; r < 10; r++) {
+        rk += 4;
+        t0 = td[s0 & 0xFF] ^ ROTL(td[(s3 >> 8) & 0xFF], 8) ^
+             ROTL(td[(s2 >> 16) & 0xFF], 16) ^ ROTL(td[s1 >> 24], 24) ^ rk[0];
+        t1 = td[s1 & 0xFF] ^ ROTL(td[(s0 >> 8) & 0xFF], 8) ^
+             ROTL(td[(s3 >> 16) & 0xFF], 16) ^ ROTL(td[s2 >> 24], 24) ^ rk[1];
+        t2 = td[s2 & 0xFF] ^ ROTL(td[(s1 >> 8) & 0xFF], 8) ^
+             ROTL(td[(s0 >> 16) & 0xFF], 16) ^ ROTL(td[s3 >> 24], 24) ^ rk[2];
+        t3 = td[s3 & 0xFF] ^ ROTL(td[(s2 >> 8) & 0xFF], 8) ^
+             ROTL(td[(s1 >> 16) & 0xFF], 16) ^ ROTL(td[s0 >> 24], 24) ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 4;
+    AES_TT_Store(out, ((uint32_t)inv_sbox[s0 & 0xFF] | ((uint32_t)inv_sbox[(s3 >> 8) & 0xFF] << 8) |
+                       ((uint32_t)inv_sbox[(s2 >> 16) & 0xFF] << 16) | ((uint32_t)inv_sbox[s1 >> 24] << 24)) ^ rk[0]);
+    AES_TT_Store(out + 4, ((uint32_t)inv_sbox[s1 & 0xFF] | ((uint32_t)inv_sbox[(s0 >> 8) & 0xFF] << 8) |
+                           ((uint32_t)inv_sbox[(s3 >> 16) & 0xFF] << 16) | ((uint32_t)inv_sbox[s2 >> 24] << 24)) ^ rk[1]);
+    AES_TT_Store(out + 8, ((uint32_t)inv_sbox[s2 & 0xFF] | ((uint32_t)inv_sbox[(s1 >> 8) & 0xFF] << 8) |
+                           ((uint32_t)inv_sbox[(s0 >> 16) & 0xFF] << 16) | ((uint32_t)inv_sbox[s3 >> 24] << 24)) ^ rk[2]);
+    AES_TT_Store(out + 12, ((uint32_t)inv_sbox[s3 & 0xFF] | ((uint32_t)inv_sbox[(s2 >> 8) & 0xFF] << 8) |
+                            ((uint32_t)inv_sbox[(s1 >> 16) & 0xFF] << 16) | ((uint32_t)inv_sbox[s0 >> 24] << 24)) ^ rk[3]);
+}
@@ -0,0 +1,82 @@
+/*
+ * chacha20.c
+ *
+ * ChaCha20 as specified in RFC 8439. Only 32-bit adds, XORs and
+ * rotations, so it runs at the same speed for any key or data and
+ * needs no tables. Any 64-byte block of the keystream can be produced
+ * directly from its counter, which lets the swap decrypt a unit in the
+ * middle of a package.
+ */
+
+#include "chacha20.h"
+
+#define ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d)                 \
+    do {                                          \
+        a += b; d ^= a; d = ROTL(d, 16);          \
+        c += d; b ^= c; b = ROTL(b, 12);          \
+        a += b; d ^= a; d = ROTL(d, 8);           \
+        c += d; b ^= c; b = ROTL(b, 7);           \
+    } while (0)
+
+static uint32_t ChaCha20_Load(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void ChaCha20_Block(const uint32_t state[16], uint8_t out[64]) {
+    uint32_t x[16];
+
+    for (int i = 0; i < 16; i++)
+        x[i] = state[i];
+
+    /* 20 rounds: a column round and a diagonal round per pass */
+    for (int i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        uint32_t w = x[i] + state[i];
+        out[4 * i]     = (uint8_t)w;
+        out[4 * i + 1] = (uint8_t)(w >> 8);
+        out[4 * i + 2] = (uint8_t)(w >> 16);
+        out[4 * i + 3] = (uint8_t)(w >> 24);
+    }
+}
+
+void ChaCha20_Xor(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                  const uint8_t *in, uint8_t *out, uint32_t len) {
+    uint32_t state[16];
+    uint8_t  block[64];
+
+    /* "expand 32-byte k" */
+    state[0] = 0x61707865;
+    state[1] = 0x3320646E;
+    state[2] = 0x79622D32;
+    state[3] = 0x6B206574;
+    for (int i = 0; i < 8; i++)
+        state[4 + i] = ChaCha20_Load(key + 4 * i);
+    state[12] = counter;
+    for (int i = 0; i < 3; i++)
+        state[13 + i] = ChaCha20_Load(nonce + 4 * i);
+
+    while (len > 0) {
+        uint32_t n = (len < 64) ? len : 64;
+
+        ChaCha20_Block(state, block);
+        for (uint32_t i = 0; i < n; i++)
+            out[i] = in[i] ^ block[i];
+
+        state[12]++;
+        in  += n;
+        out += n;
+        len -= n;
+    }
+}
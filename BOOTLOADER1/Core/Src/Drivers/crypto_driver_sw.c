@@ -4,56 +4,241 @@
  * Software cryptographic operations backed by TinyCrypt.
  * Platform-independent — reusable on any MCU.
  *
+ * AES runs on TinyCrypt or, with BL_AES_TTABLE, on the table-driven
+ * implementation in aes_ttable.c. Both sit behind the same SW_AES_* calls.
+ *
+ * With BL_ECDSA_COMB, signatures under the embedded public key are
+ * checked by ecdsa_comb.c against precomputed tables; any other key goes
+ * to uECC_verify().
+ *
  * Return convention: 0 = success, -1 = error.
  *
- * The AES key schedule is cached so that repeated calls with the
- * same key (e.g. 16K blocks during a firmware decrypt) do not
- * re-compute the schedule on every block.
+ * The AES key schedule is cached so that repeated single-block calls
+ * with the same key do not re-compute the schedule on every block.
+ * The bulk CBC/ECB calls take the schedule from a BL_AesCtx_t
+ * prepared by SW_AES_Init.
  *
  *  Created on: Feb 18, 2026
  *      Author: mertk
  */
 
 #include "crypto_driver_sw.h"
+#include "bootloader_config.h"
+#include "aes_ttable.h"
+#include "chacha20.h"
+#include "poly1305.h"
+#include "ecdsa_comb.h"
+#include "keys.h"
 #include "aes.h"
+#include "cbc_mode.h"
 #include "sha256.h"
 #include "ecc_dsa.h"
 #include <string.h>
 
-/* Cached key schedules — avoids recomputing for every block */
-static struct tc_aes_key_sched_struct enc_sched;
-static uint8_t enc_cached_key[16];
-static uint8_t enc_key_valid = 0;
+#if BL_AES_TTABLE
+_Static_assert(sizeof(AES_TT_Key_t) <= sizeof(BL_AesCtx_t),
+               "BL_AesCtx_t too small for AES_TT_Key_t");
+#else
+/* The opaque context must be able to hold TinyCrypt's key schedule */
+_Static_assert(sizeof(struct tc_aes_key_sched_struct) <= sizeof(BL_AesCtx_t),
+               "BL_AesCtx_t too small for tc_aes_key_sched_struct");
+#endif
 
-static struct tc_aes_key_sched_struct dec_sched;
-static uint8_t dec_cached_key[16];
-static uint8_t dec_key_valid = 0;
+/* Cached key schedule for the single-block calls */
+static BL_AesCtx_t block_ctx;
+static uint8_t block_cached_key[16];
+static uint8_t block_key_valid = 0;
+
+static int SW_AES_Block_Key(const uint8_t key[16]) {
+    if (!block_key_valid || memcmp(key, block_cached_key, 16) != 0) {
+        if (SW_AES_Init(&block_ctx, key) != 0)
+            return -1;
+        memcpy(block_cached_key, key, 16);
+        block_key_valid = 1;
+    }
+    return 0;
+}
 
 int SW_AES_EncryptBlock(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]) {
-    if (!enc_key_valid || memcmp(key, enc_cached_key, 16) != 0) {
-        if (tc_aes128_set_encrypt_key(&enc_sched, key) == 0)
+    if (SW_AES_Block_Key(key) != 0)
+        return -1;
+
+    return SW_AES_ECB_Encrypt(&block_ctx, in, out, 16);
+}
+
+int SW_AES_DecryptBlock(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]) {
+    if (SW_AES_Block_Key(key) != 0)
+        return -1;
+
+    return SW_AES_ECB_Decrypt(&block_ctx, in, out, 16);
+}
+
+#if BL_AES_TTABLE
+
+int SW_AES_Init(BL_AesCtx_t *ctx, const uint8_t key[16]) {
+    AES_TT_SetKey((AES_TT_Key_t *)ctx, key);
+    return 0;
+}
+
+int SW_AES_CBC_Decrypt(const BL_AesCtx_t *ctx, const uint8_t iv[16],
+                       const uint8_t *in, uint8_t *out, uint32_t len) {
+    const AES_TT_Key_t *key = (const AES_TT_Key_t *)ctx;
+    uint8_t chain[16];
+    uint8_t next[16];
+
+    if (len == 0 || (len % 16) != 0)
+        return -1;
+
+    /* The chain block is kept locally: out cannot alias it, so the XOR
+     * stays in registers, and in == out works */
+    memcpy(chain, iv, 16);
+    for (uint32_t i = 0; i < len; i += 16) {
+        memcpy(next, in + i, 16);
+        AES_TT_Decrypt(key, next, out + i);
+        for (int j = 0; j < 16; j++)
+            out[i + j] ^= chain[j];
+        memcpy(chain, next, 16);
+    }
+    return 0;
+}
+
+int SW_AES_ECB_Encrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len) {
+    if ((len % 16) != 0)
+        return -1;
+
+    for (uint32_t i = 0; i < len; i += 16)
+        AES_TT_Encrypt((const AES_TT_Key_t *)ctx, in + i, out + i);
+    return 0;
+}
+
+int SW_AES_ECB_Decrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len) {
+    if ((len % 16) != 0)
+        return -1;
+
+    for (uint32_t i = 0; i < len; i += 16)
+        AES_TT_Decrypt((const AES_TT_Key_t *)ctx, in + i, out + i);
+    return 0;
+}
+
+#else /* TinyCrypt */
+
+int SW_AES_Init(BL_AesCtx_t *ctx, const uint8_t key[16]) {
+    /* TinyCrypt decrypts with the encryption schedule */
+    if (tc_aes128_set_encrypt_key((TCAesKeySched_t)ctx, key) == 0)
+        return -1;
+
+    return 0;
+}
+
+int SW_AES_CBC_Decrypt(const BL_AesCtx_t *ctx, const uint8_t iv[16],
+                       const uint8_t *in, uint8_t *out, uint32_t len) {
+    TCAesKeySched_t sched = (TCAesKeySched_t)ctx;
+
+    if (len == 0 || (len % 16) != 0)
+        return -1;
+
+    /* tc_cbc_mode_decrypt needs the IV right in front of the ciphertext */
+    if (iv + 16 != in) {
+        uint8_t block[16];
+
+        if (tc_aes_decrypt(block, in, sched) == 0)
             return -1;
-        memcpy(enc_cached_key, key, 16);
-        enc_key_valid = 1;
+        for (int j = 0; j < 16; j++)
+            out[j] = block[j] ^ iv[j];
+
+        iv   = in;
+        in  += 16;
+        out += 16;
+        len -= 16;
+        if (len == 0)
+            return 0;
     }
 
-    if (tc_aes_encrypt(out, in, &enc_sched) == 0)
+    if (tc_cbc_mode_decrypt(out, len, in, len, iv, sched) == 0)
         return -1;
 
     return 0;
 }
 
-int SW_AES_DecryptBlock(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]) {
-    if (!dec_key_valid || memcmp(key, dec_cached_key, 16) != 0) {
-        if (tc_aes128_set_decrypt_key(&dec_sched, key) == 0)
+int SW_AES_ECB_Encrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len) {
+    if ((len % 16) != 0)
+        return -1;
+
+    for (uint32_t i = 0; i < len; i += 16) {
+        if (tc_aes_encrypt(out + i, in + i, (TCAesKeySched_t)ctx) == 0)
             return -1;
-        memcpy(dec_cached_key, key, 16);
-        dec_key_valid = 1;
     }
+    return 0;
+}
 
-    if (tc_aes_decrypt(out, in, &dec_sched) == 0)
+int SW_AES_ECB_Decrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len) {
+    if ((len % 16) != 0)
         return -1;
 
+    for (uint32_t i = 0; i < len; i += 16) {
+        if (tc_aes_decrypt(out + i, in + i, (TCAesKeySched_t)ctx) == 0)
+            return -1;
+    }
+    return 0;
+}
+
+#endif /* BL_AES_TTABLE */
+
+/* Counter blocks are encrypted 16 at a time through the ECB call */
+#define SW_CTR_BATCH  16
+
+int SW_AES_CTR_Xor(const BL_AesCtx_t *ctx, const uint8_t ctr[16],
+                   const uint8_t *in, uint8_t *out, uint32_t len) {
+    uint8_t counter[16];
+    uint8_t blocks[SW_CTR_BATCH * 16];
+
+    memcpy(counter, ctr, 16);
+
+    while (len > 0) {
+        uint32_t n = (len < sizeof(blocks)) ? len : sizeof(blocks);
+        uint32_t count = (n + 15) / 16;
+
+        for (uint32_t b = 0; b < count; b++) {
+            memcpy(blocks + 16 * b, counter, 16);
+            for (int j = 15; j >= 0 && ++counter[j] == 0; j--)
+                ;
+        }
+
+        if (SW_AES_ECB_Encrypt(ctx, blocks, blocks, count * 16) != 0)
+            return -1;
+
+        for (uint32_t i = 0; i < n; i++)
+            out[i] = in[i] ^ blocks[i];
+
+        in  += n;
+        out += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int SW_CHACHA20_Xor(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                    const uint8_t *in, uint8_t *out, uint32_t len) {
+    ChaCha20_Xor(key, nonce, counter, in, out, len);
+    return 0;
+}
+
+/* The opaque context must be able to hold the Poly1305 state */
+_Static_assert(sizeof(Poly1305_Ctx_t) <= sizeof(BL_PolyCtx_t),
+               "BL_PolyCtx_t too small for Poly1305_Ctx_t");
+
+int SW_POLY1305_Init(BL_PolyCtx_t *ctx, const uint8_t key[32]) {
+    Poly1305_Init((Poly1305_Ctx_t *)ctx, key);
+    return 0;
+}
+
+int SW_POLY1305_Update(BL_PolyCtx_t *ctx, const uint8_t *data, uint32_t len) {
+    Poly1305_Update((Poly1305_Ctx_t *)ctx, data, len);
+    return 0;
+}
+
+int SW_POLY1305_Final(BL_PolyCtx_t *ctx, uint8_t tag[16]) {
+    Poly1305_Final((Poly1305_Ctx_t *)ctx, tag);
     return 0;
 }
 
@@ -70,8 +255,38 @@ int SW_SHA256(const uint8_t *data, uint32_t len, uint8_t digest[32]) {
     return 0;
 }
 
+/* The opaque context must be able to hold TinyCrypt's SHA-256 state */
+_Static_assert(sizeof(struct tc_sha256_state_struct) <= sizeof(BL_HashCtx_t),
+               "BL_HashCtx_t too small for tc_sha256_state_struct");
+
+int SW_SHA256_Init(BL_HashCtx_t *ctx) {
+    if (tc_sha256_init((TCSha256State_t)ctx) != 1)
+        return -1;
+
+    return 0;
+}
+
+int SW_SHA256_Update(BL_HashCtx_t *ctx, const uint8_t *data, uint32_t len) {
+    if (tc_sha256_update((TCSha256State_t)ctx, data, len) != 1)
+        return -1;
+
+    return 0;
+}
+
+int SW_SHA256_Final(BL_HashCtx_t *ctx, uint8_t digest[32]) {
+    if (tc_sha256_final(digest, (TCSha256State_t)ctx) != 1)
+        return -1;
+
+    return 0;
+}
+
 int SW_ECDSA_Verify(const uint8_t *pub_key, const uint8_t *hash,
                     uint32_t hash_len, const uint8_t *sig) {
+#if BL_ECDSA_COMB
+    if (memcmp(pub_key, ECDSA_public_key_comb.public_key, 64) == 0)
+        return (ECDSA_Comb_Verify(&ECDSA_public_key_comb, hash, hash_len, sig) == 1) ? 0 : -1;
+#endif
+
     if (uECC_verify(pub_key, hash, hash_len, sig, uECC_secp256r1()) == 1)
         return 0;
 
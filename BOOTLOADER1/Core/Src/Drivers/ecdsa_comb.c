@@ -0,0 +1,216 @@
+/*
+ * ecdsa_comb.c
+ *
+ * ECDSA P-256 verification, u1*G + u2*Q, with the Lim-Lee comb method.
+ * Each scalar is split into ECDSA_COMB_TEETH slices of ECDSA_COMB_ROWS
+ * bits; bit `row` of every slice indexes one precomputed point. Both
+ * scalars share the doublings, so a verify costs ECDSA_COMB_ROWS (52)
+ * doublings and at most 2 * 52 mixed additions. uECC_verify's Shamir
+ * ladder needs 255 doublings and about 190 additions.
+ *
+ * Accumulator in Jacobian coordinates, table points affine. Everything
+ * here is public data, so the code branches freely.
+ *
+ * Field multiplies go through Fe_Mul/Fe_Sqr: the unrolled P-256 kernels
+ * of p256_field.c with BL_P256_UNROLLED, TinyCrypt's generic ones
+ * otherwise.
+ */
+
+#include "ecdsa_comb.h"
+#include "bootloader_config.h"
+#include "p256_field.h"
+#include "ecc.h"
+
+#define W NUM_ECC_WORDS
+
+typedef struct {
+    uECC_word_t x[W];
+    uECC_word_t y[W];
+    uECC_word_t z[W];
+    uint8_t     infinity;
+} Comb_Point_t;
+
+static uECC_Curve curve;
+
+static void Fe_Mul(uECC_word_t *r, const uECC_word_t *a, const uECC_word_t *b) {
+#if BL_P256_UNROLLED
+    P256_Mul((uint32_t *)r, (const uint32_t *)a, (const uint32_t *)b);
+#else
+    uECC_vli_modMult_fast(r, a, b, curve);
+#endif
+}
+
+static void Fe_Sqr(uECC_word_t *r, const uECC_word_t *a) {
+#if BL_P256_UNROLLED
+    P256_Sqr((uint32_t *)r, (const uint32_t *)a);
+#else
+    uECC_vli_modMult_fast(r, a, a, curve);
+#endif
+}
+
+static void Fe_Add(uECC_word_t *r, const uECC_word_t *a, const uECC_word_t *b) {
+    uECC_vli_modAdd(r, a, b, curve->p, W);
+}
+
+static void Fe_Sub(uECC_word_t *r, const uECC_word_t *a, const uECC_word_t *b) {
+    uECC_vli_modSub(r, a, b, curve->p, W);
+}
+
+/* a = a / 2 mod p */
+static void Fe_Half(uECC_word_t *a) {
+    uint32_t top = 0;
+
+    if (a[0] & 1U) {
+        uint64_t sum = 0;
+        for (int i = 0; i < W; i++) {
+            sum += (uint64_t)a[i] + curve->p[i];
+            a[i] = (uECC_word_t)sum;
+            sum >>= 32;
+        }
+        top = (uint32_t)sum;
+    }
+    for (int i = 0; i < W - 1; i++)
+        a[i] = (a[i] >> 1) | (a[i + 1] << 31);
+    a[W - 1] = (a[W - 1] >> 1) | (top << 31);
+}
+
+/* R = 2R for a = -3, as double_jacobian_default() in ecc.c: 4M + 4S */
+static void Comb_Double(Comb_Point_t *R) {
+    uECC_word_t t4[W], t5[W];
+    uECC_word_t *x = R->x, *y = R->y, *z = R->z;
+
+    Fe_Sqr(t4, y);              /* y^2                */
+    Fe_Mul(t5, x, t4);          /* A = x * y^2        */
+    Fe_Sqr(t4, t4);             /* y^4                */
+    Fe_Mul(y, y, z);            /* z3 = y * z         */
+    Fe_Sqr(z, z);               /* z^2                */
+
+    Fe_Add(x, x, z);            /* x + z^2            */
+    Fe_Add(z, z, z);
+    Fe_Sub(z, x, z);            /* x - z^2            */
+    Fe_Mul(x, x, z);            /* x^2 - z^4          */
+
+    Fe_Add(z, x, x);
+    Fe_Add(x, x, z);            /* 3 (x^2 - z^4)      */
+    Fe_Half(x);                 /* B = 3/2 (x^2 - z^4) */
+
+    Fe_Sqr(z, x);
+    Fe_Sub(z, z, t5);
+    Fe_Sub(z, z, t5);           /* x3 = B^2 - 2A      */
+    Fe_Sub(t5, t5, z);
+    Fe_Mul(x, x, t5);
+    Fe_Sub(t4, x, t4);          /* y3 = B (A - x3) - y^4 */
+
+    uECC_vli_set(x, z, W);
+    uECC_vli_set(z, y, W);
+    uECC_vli_set(y, t4, W);
+}
+
+/* R += (x2, y2): mixed addition, 8M + 3S */
+static void Comb_Add(Comb_Point_t *R, const uint32_t *point) {
+    const uECC_word_t *x2 = (const uECC_word_t *)point;
+    const uECC_word_t *y2 = (const uECC_word_t *)point + W;
+    uECC_word_t t1[W], t2[W], h[W], r[W];
+
+    if (R->infinity) {
+        uECC_vli_set(R->x, x2, W);
+        uECC_vli_set(R->y, y2, W);
+        uECC_vli_clear(R->z, W);
+        R->z[0] = 1;
+        R->infinity = 0;
+        return;
+    }
+
+    Fe_Sqr(t1, R->z);           /* Z1^2               */
+    Fe_Mul(t2, y2, R->z);
+    Fe_Mul(t2, t2, t1);         /* S2 = y2 * Z1^3     */
+    Fe_Mul(t1, x2, t1);         /* U2 = x2 * Z1^2     */
+    Fe_Sub(h, t1, R->x);        /* H  = U2 - X1       */
+    Fe_Sub(r, t2, R->y);        /* r  = S2 - Y1       */
+
+    if (uECC_vli_isZero(h, W)) {
+        if (uECC_vli_isZero(r, W))
+            Comb_Double(R);                                   /* R == P  */
+        else
+            R->infinity = 1;                                  /* R == -P */
+        return;
+    }
+
+    Fe_Mul(R->z, R->z, h);      /* Z3 = Z1 * H        */
+    Fe_Sqr(t1, h);              /* HH                 */
+    Fe_Mul(t2, t1, h);          /* HHH                */
+    Fe_Mul(t1, R->x, t1);       /* V  = X1 * HH       */
+    Fe_Sqr(R->x, r);
+    Fe_Sub(R->x, R->x, t2);
+    Fe_Sub(R->x, R->x, t1);
+    Fe_Sub(R->x, R->x, t1);     /* X3 = r^2 - HHH - 2V */
+    Fe_Sub(t1, t1, R->x);
+    Fe_Mul(t1, t1, r);
+    Fe_Mul(t2, R->y, t2);
+    Fe_Sub(R->y, t1, t2);       /* Y3 = r(V - X3) - Y1 * HHH */
+}
+
+/* Table index for one comb row: bit `row` of each slice of k */
+static uint32_t Comb_Index(const uECC_word_t *k, uint32_t row) {
+    uint32_t index = 0;
+
+    for (uint32_t i = 0; i < ECDSA_COMB_TEETH; i++) {
+        uint32_t bit = i * ECDSA_COMB_ROWS + row;
+        if (bit < 256 && uECC_vli_testBit(k, (bitcount_t)bit))
+            index |= 1U << i;
+    }
+    return index;
+}
+
+int ECDSA_Comb_Verify(const ECDSA_CombTable_t *q, const uint8_t *hash,
+                      uint32_t hash_len, const uint8_t *sig) {
+    uECC_word_t r[W], s[W], z[W], u1[W], u2[W];
+    Comb_Point_t R;
+
+    curve = uECC_secp256r1();
+
+    uECC_vli_bytesToNative(r, sig, NUM_ECC_BYTES);
+    uECC_vli_bytesToNative(s, sig + NUM_ECC_BYTES, NUM_ECC_BYTES);
+
+    /* 0 < r, s < n */
+    if (uECC_vli_isZero(r, W) || uECC_vli_isZero(s, W) ||
+        uECC_vli_cmp_unsafe(curve->n, r, W) != 1 ||
+        uECC_vli_cmp_unsafe(curve->n, s, W) != 1)
+        return 0;
+
+    /* e = leftmost 256 bits of the hash, as bits2int() in ecc_dsa.c */
+    uECC_vli_clear(u1, W);
+    uECC_vli_bytesToNative(u1, hash, (hash_len < NUM_ECC_BYTES) ? (int)hash_len : NUM_ECC_BYTES);
+
+    uECC_vli_modInv(z, s, curve->n, W);            /* z  = 1/s */
+    uECC_vli_modMult(u1, u1, z, curve->n, W);      /* u1 = e/s */
+    uECC_vli_modMult(u2, r, z, curve->n, W);       /* u2 = r/s */
+
+    R.infinity = 1;
+    for (int row = ECDSA_COMB_ROWS - 1; row >= 0; row--) {
+        uint32_t index;
+
+        if (!R.infinity)
+            Comb_Double(&R);
+
+        index = Comb_Index(u1, (uint32_t)row);
+        if (index)
+            Comb_Add(&R, ECDSA_G_comb.points[index - 1]);
+
+        index = Comb_Index(u2, (uint32_t)row);
+        if (index)
+            Comb_Add(&R, q->points[index - 1]);
+    }
+
+    if (R.infinity)
+        return 0;
+
+    /* x = X / Z^2, then v = x mod n */
+    uECC_vli_modInv(z, R.z, curve->p, W);
+    Fe_Sqr(z, z);
+    Fe_Mul(R.x, R.x, z);
+    if (uECC_vli_cmp_unsafe(curve->n, R.x, W) != 1)
+        uECC_vli_sub(R.x, R.x, curve->n, W);
+
+    return uECC_vli_equal(R.x, r, W) == 0;
+}
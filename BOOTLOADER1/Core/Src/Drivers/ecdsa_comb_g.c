@@ -0,0 +1,148 @@
+/*
+ * ecdsa_comb_g.c
+ *
+ * Comb table for the P-256 base point, used by ecdsa_comb.c.
+ * Generated by Key/extract_pubkey.py --g-table; do not edit.
+ */
+
+#include "ecdsa_comb.h"
+
+/* P-256 base point, 5-teeth comb (extract_pubkey.py --g-table) */
+const ECDSA_CombTable_t ECDSA_G_comb = {
+    .public_key = {
+        0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47,
+        0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+        0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0,
+        0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+        0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B,
+        0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+        0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE,
+        0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5
+    },
+    .points = {
+        {
+            0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81, 0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2,
+            0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357, 0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2
+        },
+        {
+            0x071E5C83, 0xEEA6BC92, 0x8542A0BE, 0x8BD27F19, 0x2A58E5B1, 0x20A845B7, 0x5026D73F, 0x54CCC941,
+            0x140916A1, 0xCFD08EF7, 0x5D8EE496, 0x929E0BCC, 0xDAD2BF22, 0x3A8F8715, 0xB4514532, 0x1C433F45
+        },
+        {
+            0x04BAC870, 0xF7D24BB7, 0x3A23C6AB, 0x593A09A0, 0xF94C9D1D, 0xDFCC2358, 0x297BED02, 0x3CFA0F87,
+            0x40F26940, 0xCE98A30B, 0x0248A8AF, 0x62121C0D, 0x8309AF9B, 0xA758AA80, 0x70BE12C6, 0xE4E37694
+        },
+        {
+            0x3ECCA7E0, 0xC739A5EA, 0x6743333E, 0xA7D2C98F, 0x224D9428, 0x0FEF6335, 0x5C792A0C, 0x7EF2EE3C,
+            0x552AC094, 0x302B22DD, 0xDFBD3D20, 0x81B21450, 0xD5E609DB, 0xA4F67F51, 0x30ACC011, 0xAFB68627
+        },
+        {
+            0x86EF7D7D, 0xDD37E3FF, 0x088B86DB, 0xF6D77C27, 0x254C5491, 0x28FE9A4F, 0x6DF0FD5E, 0xD6690337,
+            0xADDAD596, 0x9FF04992, 0x9E4373F9, 0xF3D1A7AF, 0xDF074167, 0xA13E9578, 0xE6D13D22, 0x20E2A53C
+        },
+        {
+            0xB0879605, 0xD7B86AEE, 0xBE3C7265, 0xA424EC2D, 0x12F01E9E, 0x276203C2, 0xB77E46E9, 0xB666FAC5,
+            0x3BF0C52D, 0xF431BB1A, 0x726CD8B6, 0xEF46A44A, 0xEE3DE5A9, 0xEB5ABC19, 0x90246904, 0x38AAA380
+        },
+        {
+            0x525D6ABF, 0xAEBFD735, 0x96BEA25A, 0xC302F8F4, 0x544920A4, 0xDB82B3EA, 0x02EADB2E, 0x621C75D1,
+            0x9EF485F0, 0x8939DC4C, 0x57C46D63, 0x225D03D8, 0x522D7F70, 0x4FDAC96F, 0xB4FA649D, 0xD7C4A4FE
+        },
+        {
+            0x943E832A, 0x9C762EF1, 0x1786DF70, 0x07E50AB0, 0x2589F18E, 0x90F573A8, 0xA7C2A51A, 0x0D2BF28B,
+            0x5B20D37C, 0x48263AF1, 0x60551446, 0x27EC9DB9, 0x94B4E7ED, 0x7087A10A, 0x13BD00AC, 0x0CAC3F43
+        },
+        {
+            0xC0B9372A, 0x8BC659AA, 0xEDD9583F, 0xF7659958, 0x8C267D88, 0x9F05F94A, 0xC99A739D, 0x00DC46E7,
+            0xDF55D0F2, 0x4AF50A00, 0x8156BF6A, 0xB5EB202D, 0x5228C111, 0x40D1E3AB, 0x45793424, 0x0312A557
+        },
+        {
+            0x9E6486E0, 0x9D90CDA8, 0x1C7522C0, 0xC8A820BD, 0x08DCD7AB, 0x867C5580, 0x882A7892, 0x3C510CE2,
+            0x646D54C6, 0x0E283334, 0xEDA4E046, 0x33392776, 0x5BA997B0, 0xC3A7FC08, 0x5ACF053F, 0xD35E620F
+        },
+        {
+            0x7EB8CFEE, 0x8D9692F7, 0x0D8C013D, 0x05E3F223, 0x84E32E59, 0x76347A52, 0x15B0A1E5, 0x3C53E290,
+            0xFAE798D4, 0x538B7DA5, 0x00D23591, 0x1B9F1BD1, 0x9A08693F, 0x11A9F072, 0x140EFEB3, 0xD30E7CDA
+        },
+        {
+            0x4DD6C004, 0x81DEC926, 0xDAD210D5, 0xBFED14FE, 0xB96B9911, 0x39F9FF69, 0x29C2024D, 0x02FD7B73,
+            0x715D29FC, 0x50CFCEB8, 0x0C236311, 0xB682B999, 0xC7797831, 0x00F34ADD, 0x59927DF3, 0x42EBD3CB
+        },
+        {
+            0xF8E8F683, 0x6DFCF787, 0x3F7FBE90, 0x13D72B7A, 0x2DF232CF, 0xFD426D94, 0x5FE39AAD, 0xED84BB42,
+            0x732995FC, 0x023E67A1, 0x355430E3, 0x67DD0A8E, 0x97A1D703, 0x0CF83B61, 0x583C33F2, 0xA3233455
+        },
+        {
+            0x68142904, 0x27014AB4, 0x00CFA617, 0xFB500882, 0x7009B958, 0x6745FF87, 0xD449242D, 0x9E9889BC,
+            0x575616C8, 0x035B613B, 0x138E99E2, 0x00855156, 0x292E6AA0, 0x94C0D24B, 0x7E79B3A2, 0xD9BA5B68
+        },
+        {
+            0x5F165D99, 0xCEBBBC7B, 0x8A4EEE61, 0x50CC51C1, 0x1B4D0D1F, 0xB31D2353, 0x66382ADA, 0x95E18452,
+            0x0A839B5B, 0xACAD4F81, 0x4142FF0F, 0xA0A2A96E, 0x1F4FA12F, 0x3EAA8289, 0x6B0FB8F3, 0x68D68C8F
+        },
+        {
+            0x839BB85F, 0x320F09C3, 0xA050E62C, 0x0101FB06, 0x9AD53458, 0x557582C9, 0x1666432B, 0x55D5398D,
+            0x4FED936F, 0xF7F63118, 0x1833D9E1, 0xD90D6A7F, 0x8EBAA72A, 0x059C6A9E, 0x49FF8E2D, 0x576E2290
+        },
+        {
+            0x51BBB3F1, 0x9311A269, 0x8D0F4F65, 0xE80F26BD, 0x6BECCBB9, 0x9D3DC334, 0x101E5DE4, 0x54E244D5,
+            0xF1B19E28, 0xB3AD4C6E, 0x58C2E3B7, 0x4334FBC0, 0x35DF9C25, 0x19BD4107, 0xEC106EB6, 0xD6BBEC0E
+        },
+        {
+            0xE5046DC5, 0x788251C7, 0xF179327B, 0x12839B95, 0x4A8CB46E, 0xF1C05D98, 0x3C00736B, 0x443737CD,
+            0x12CD8FE5, 0xA760A456, 0x0817BDD9, 0x797489DE, 0xF42C23E8, 0xC56EB80A, 0xE6FE7AF5, 0x83719DD7
+        },
+        {
+            0x3FEFCFC8, 0xE8881A83, 0xB9B5290B, 0xAEA3C9E0, 0x771E4688, 0x10B37ECD, 0xD4D021B6, 0xEE0816A3,
+            0xB3A8CAA1, 0x8E9929BF, 0xC105F2D1, 0x48915DCF, 0xDB49019F, 0x3A5FDF82, 0xAD9006E1, 0xC4A438E3
+        },
+        {
+            0x87DE4B29, 0x5DB9620F, 0xD91ECB2E, 0xD7420C18, 0x32ACF105, 0x301BA1B2, 0x7853A937, 0xDB96BB0C,
+            0xC359AC34, 0xD84BFEF6, 0x64852A1D, 0xAB80CEF0, 0xB9DA1717, 0x3FBEE4D3, 0x7A13222C, 0xB325074E
+        },
+        {
+            0xE83AD2C9, 0x5D6DC503, 0xAED035BE, 0xCA9F7A1D, 0xCBD21E33, 0x552788AC, 0xE09CB9F0, 0x8699DD31,
+            0x329BF961, 0x38584196, 0xB82A5AF9, 0x4CB20E96, 0xC72C78C1, 0x24199908, 0xE92859B7, 0x16E65484
+        },
+        {
+            0x052FDE29, 0x6A201C4B, 0x0031DBB4, 0x6C897123, 0x16C1DA96, 0x4A759982, 0x2CC67214, 0xEEC0B975,
+            0x812C864E, 0xB908B9F1, 0x8439F6BA, 0x367FB66A, 0xF966F329, 0x789D664B, 0xF7F1D283, 0xE02AF770
+        },
+        {
+            0xDB3038DD, 0xA20A2C70, 0xE99D5C7C, 0x5F0B46D5, 0x4B600B83, 0xC9B97D37, 0x3DF3245E, 0x186C7F79,
+            0x4F1CE57F, 0x2AF72460, 0x91E2D8ED, 0x9249897F, 0x8D2EA797, 0x8139B36A, 0x9AB58913, 0x9C428DB8
+        },
+        {
+            0x6471AAA0, 0xB4A196FB, 0x1B6B9730, 0xDCBAB650, 0x295B57D2, 0x7AFCCC8A, 0x4E33A65D, 0xEE2280F4,
+            0x890FCD12, 0xC47A0803, 0x82604F6B, 0x4E98A98D, 0xED5FBBD2, 0x0D598F06, 0xA6A1EB84, 0xCE46EC91
+        },
+        {
+            0x4BE6458D, 0x1F1E4F3F, 0x595E6547, 0x5F72CC22, 0x271A93F1, 0x5BC5341E, 0x58A5F263, 0xC62E155C,
+            0x58BA7FF4, 0x5F6F845A, 0x7E36A6AD, 0x67E1F7DC, 0xEEAA4D04, 0xD33A7657, 0x18267E4E, 0xFF9F2322
+        },
+        {
+            0x4A53789F, 0xD369F11F, 0x3696B437, 0xC7876FB6, 0x0BABA29A, 0xA0E8F0A7, 0x32F6E514, 0xA0318A5F,
+            0x11775A08, 0x5C4A43D1, 0x362EEBB1, 0x418C507C, 0x09A325AA, 0xFD08903F, 0xF0EEBB3A, 0xF320B8FC
+        },
+        {
+            0xC7644C1D, 0xE33F0255, 0xBB9002D8, 0x4030ECC3, 0xF4646F9F, 0xA4486916, 0x959C44FA, 0x5E677D0C,
+            0xD88B9144, 0xE2E7D7D0, 0x6248F91F, 0x5D93A86F, 0x02993AEA, 0xE33D0BD5, 0x3100D31E, 0x449F0CE6
+        },
+        {
+            0x73CF2678, 0x3FCD925A, 0xA6D0AFC7, 0x34CA923B, 0x3067791F, 0x9011091D, 0x5A7941E4, 0x8C568874,
+            0xFC339800, 0x34D37180, 0x595C51F4, 0x7744316B, 0xE88C6420, 0xF2DDB693, 0x5BAD14D2, 0xFB3A48B1
+        },
+        {
+            0xFDAAB256, 0x52DF1588, 0x3127354C, 0x68C0CD44, 0xA591F853, 0x2A849471, 0x93D0CB92, 0xE4DA88E9,
+            0x1639C624, 0x6D1EA35D, 0x263707BA, 0x60FE2A36, 0xD0F3BC51, 0x97FC50DE, 0x10062E80, 0xF7FA4D15
+        },
+        {
+            0x024C168D, 0xC429A113, 0x3FEAA272, 0xB6C935FB, 0xE639EC09, 0xB58A6071, 0xF9C13DE7, 0x4B59253A,
+            0xFBFB8955, 0x6D2D68F2, 0x50723FE2, 0xF0064C12, 0x01F185F5, 0xE85D7820, 0x7FA79C93, 0xAA0307BF
+        },
+        {
+            0x5B696527, 0x2E75A266, 0x5A00169C, 0x1A2530B0, 0x4286FB42, 0x76C4C180, 0x8E831D5B, 0x825F0194,
+            0xEF703739, 0xDBF0A11F, 0xCE5B106A, 0x106F9BC4, 0x24111150, 0x61794C4F, 0xBC723A17, 0x435872FE
+        },
+    }
+};
@@ -0,0 +1,203 @@
+/*
+ * p256_field.c
+ *
+ * secp256r1 field arithmetic for 32-bit targets: 8x8-word multiply and
+ * square fully unrolled in product-scanning (Comba) order, followed by
+ * the NIST fast reduction with one signed accumulator per word. Same
+ * results as TinyCrypt's uECC_vli_modMult_fast(), whose generic loops
+ * over num_words spend most of their time on loop and carry bookkeeping.
+ *
+ * Each MULADD is one 32x32->64 multiply-accumulate into the three-word
+ * column accumulator (c2:c1:c0); on Cortex-M this maps to UMULL/ADDS.
+ */
+
+#include "p256_field.h"
+
+#define MULADD(x, y)                                                  \
+    do {                                                              \
+        uint64_t t_ = (uint64_t)(x) * (y);                            \
+        uint64_t s_ = (((uint64_t)c1 << 32) | c0) + t_;               \
+        c2 += (s_ < t_);                                              \
+        c1 = (uint32_t)(s_ >> 32);                                    \
+        c0 = (uint32_t)s_;                                            \
+    } while (0)
+
+/* x*y twice: the off-diagonal terms of a square */
+#define MULADD2(x, y)                                                 \
+    do {                                                              \
+        uint64_t t_ = (uint64_t)(x) * (y);                            \
+        uint64_t s_ = (((uint64_t)c1 << 32) | c0) + t_;               \
+        c2 += (s_ < t_);                                              \
+        s_ += t_;                                                     \
+        c2 += (s_ < t_);                                              \
+        c1 = (uint32_t)(s_ >> 32);                                    \
+        c0 = (uint32_t)s_;                                            \
+    } while (0)
+
+#define COLUMN(k)                                                     \
+    do {                                                              \
+        product[k] = c0;                                              \
+        c0 = c1;                                                      \
+        c1 = c2;                                                      \
+        c2 = 0;                                                       \
+    } while (0)
+
+/* p = 2^256 - 2^224 + 2^192 + 2^96 - 1, little-endian words */
+static const uint32_t p256_p[8] = {
+    0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000,
+    0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF
+};
+
+static void P256_Mul_Wide(uint32_t product[16], const uint32_t a[8], const uint32_t b[8]) {
+    uint32_t c0 = 0, c1 = 0, c2 = 0;
+
+    MULADD(a[0], b[0]);
+    COLUMN(0);
+    MULADD(a[0], b[1]); MULADD(a[1], b[0]);
+    COLUMN(1);
+    MULADD(a[0], b[2]); MULADD(a[1], b[1]); MULADD(a[2], b[0]);
+    COLUMN(2);
+    MULADD(a[0], b[3]); MULADD(a[1], b[2]); MULADD(a[2], b[1]); MULADD(a[3], b[0]);
+    COLUMN(3);
+    MULADD(a[0], b[4]); MULADD(a[1], b[3]); MULADD(a[2], b[2]); MULADD(a[3], b[1]);
+    MULADD(a[4], b[0]);
+    COLUMN(4);
+    MULADD(a[0], b[5]); MULADD(a[1], b[4]); MULADD(a[2], b[3]); MULADD(a[3], b[2]);
+    MULADD(a[4], b[1]); MULADD(a[5], b[0]);
+    COLUMN(5);
+    MULADD(a[0], b[6]); MULADD(a[1], b[5]); MULADD(a[2], b[4]); MULADD(a[3], b[3]);
+    MULADD(a[4], b[2]); MULADD(a[5], b[1]); MULADD(a[6], b[0]);
+    COLUMN(6);
+    MULADD(a[0], b[7]); MULADD(a[1], b[6]); MULADD(a[2], b[5]); MULADD(a[3], b[4]);
+    MULADD(a[4], b[3]); MULADD(a[5], b[2]); MULADD(a[6], b[1]); MULADD(a[7], b[0]);
+    COLUMN(7);
+    MULADD(a[1], b[7]); MULADD(a[2], b[6]); MULADD(a[3], b[5]); MULADD(a[4], b[4]);
+    MULADD(a[5], b[3]); MULADD(a[6], b[2]); MULADD(a[7], b[1]);
+    COLUMN(8);
+    MULADD(a[2], b[7]); MULADD(a[3], b[6]); MULADD(a[4], b[5]); MULADD(a[5], b[4]);
+    MULADD(a[6], b[3]); MULADD(a[7], b[2]);
+    COLUMN(9);
+    MULADD(a[3], b[7]); MULADD(a[4], b[6]); MULADD(a[5], b[5]); MULADD(a[6], b[4]);
+    MULADD(a[7], b[3]);
+    COLUMN(10);
+    MULADD(a[4], b[7]); MULADD(a[5], b[6]); MULADD(a[6], b[5]); MULADD(a[7], b[4]);
+    COLUMN(11);
+    MULADD(a[5], b[7]); MULADD(a[6], b[6]); MULADD(a[7], b[5]);
+    COLUMN(12);
+    MULADD(a[6], b[7]); MULADD(a[7], b[6]);
+    COLUMN(13);
+    MULADD(a[7], b[7]);
+    COLUMN(14);
+    product[15] = c0;
+}
+
+static void P256_Sqr_Wide(uint32_t product[16], const uint32_t a[8]) {
+    uint32_t c0 = 0, c1 = 0, c2 = 0;
+
+    MULADD(a[0], a[0]);
+    COLUMN(0);
+    MULADD2(a[0], a[1]);
+    COLUMN(1);
+    MULADD2(a[0], a[2]); MULADD(a[1], a[1]);
+    COLUMN(2);
+    MULADD2(a[0], a[3]); MULADD2(a[1], a[2]);
+    COLUMN(3);
+    MULADD2(a[0], a[4]); MULADD2(a[1], a[3]); MULADD(a[2], a[2]);
+    COLUMN(4);
+    MULADD2(a[0], a[5]); MULADD2(a[1], a[4]); MULADD2(a[2], a[3]);
+    COLUMN(5);
+    MULADD2(a[0], a[6]); MULADD2(a[1], a[5]); MULADD2(a[2], a[4]); MULADD(a[3], a[3]);
+    COLUMN(6);
+    MULADD2(a[0], a[7]); MULADD2(a[1], a[6]); MULADD2(a[2], a[5]); MULADD2(a[3], a[4]);
+    COLUMN(7);
+    MULADD2(a[1], a[7]); MULADD2(a[2], a[6]); MULADD2(a[3], a[5]); MULADD(a[4], a[4]);
+    COLUMN(8);
+    MULADD2(a[2], a[7]); MULADD2(a[3], a[6]); MULADD2(a[4], a[5]);
+    COLUMN(9);
+    MULADD2(a[3], a[7]); MULADD2(a[4], a[6]); MULADD(a[5], a[5]);
+    COLUMN(10);
+    MULADD2(a[4], a[7]); MULADD2(a[5], a[6]);
+    COLUMN(11);
+    MULADD2(a[5], a[7]); MULADD(a[6], a[6]);
+    COLUMN(12);
+    MULADD2(a[6], a[7]);
+    COLUMN(13);
+    MULADD(a[7], a[7]);
+    COLUMN(14);
+    product[15] = c0;
+}
+
+void P256_Reduce(uint32_t result[8], const uint32_t product[16]) {
+    const uint32_t *c = product;
+    int64_t acc;
+    int64_t carry;
+    uint32_t r[8];
+    uint32_t borrow;
+
+    /*
+     * FIPS 186-4 D.2.3: t + 2 s1 + 2 s2 + s3 + s4 - d1 - d2 - d3 - d4,
+     * one column at a time. Each column fits easily in 64 bits; the
+     * arithmetic shift keeps the running carry signed.
+     */
+    acc = (int64_t)c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+    r[0] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+    r[1] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+    r[2] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[3] + 2 * (int64_t)c[11] + 2 * (int64_t)c[12] + c[13]
+          - c[15] - c[8] - c[9];
+    r[3] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[4] + 2 * (int64_t)c[12] + 2 * (int64_t)c[13] + c[14]
+          - c[9] - c[10];
+    r[4] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[5] + 2 * (int64_t)c[13] + 2 * (int64_t)c[14] + c[15]
+          - c[10] - c[11];
+    r[5] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[6] + 3 * (int64_t)c[14] + 2 * (int64_t)c[15] + c[13]
+          - c[8] - c[9];
+    r[6] = (uint32_t)acc; carry = acc >> 32;
+    acc = carry + c[7] + 3 * (int64_t)c[15] + c[8]
+          - c[10] - c[11] - c[12] - c[13];
+    r[7] = (uint32_t)acc; carry = acc >> 32;
+
+    /* Fold the top carry back in: 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod p) */
+    while (carry != 0) {
+        int64_t k = carry;
+
+        acc = (int64_t)r[0] + k;        r[0] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[1];             r[1] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[2];             r[2] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[3] - k;         r[3] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[4];             r[4] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[5];             r[5] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[6] - k;         r[6] = (uint32_t)acc; carry = acc >> 32;
+        acc = carry + r[7] + k;         r[7] = (uint32_t)acc; carry = acc >> 32;
+    }
+
+    /* r < 2^256 < 2p: at most one subtraction left */
+    borrow = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t d = (uint64_t)r[i] - p256_p[i] - borrow;
+        result[i] = (uint32_t)d;
+        borrow = (uint32_t)(d >> 32) & 1U;
+    }
+    if (borrow) {
+        for (int i = 0; i < 8; i++)
+            result[i] = r[i];
+    }
+}
+
+void P256_Mul(uint32_t result[8], const uint32_t a[8], const uint32_t b[8]) {
+    uint32_t product[16];
+
+    P256_Mul_Wide(product, a, b);
+    P256_Reduce(result, product);
+}
+
+void P256_Sqr(uint32_t result[8], const uint32_t a[8]) {
+    uint32_t product[16];
+
+    P256_Sqr_Wide(product, a);
+    P256_Reduce(result, product);
+}
@@ -0,0 +1,160 @@
+/*
+ * poly1305.c
+ *
+ * Poly1305 (RFC 8439) with the accumulator in five 26-bit limbs, so each
+ * 16-byte block costs 25 32x32->64 multiplies and no carries inside the
+ * products. Same arithmetic as the public-domain poly1305-donna-32.
+ */
+
+#include "poly1305.h"
+#include <string.h>
+
+#define MASK26 0x3FFFFFFU
+
+static uint32_t Poly1305_Load(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void Poly1305_Store(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void Poly1305_Init(Poly1305_Ctx_t *ctx, const uint8_t key[32]) {
+    /* r &= 0x0ffffffc0ffffffc0ffffffc0fffffff */
+    ctx->r[0] = (Poly1305_Load(key +  0)     ) & 0x3FFFFFF;
+    ctx->r[1] = (Poly1305_Load(key +  3) >> 2) & 0x3FFFF03;
+    ctx->r[2] = (Poly1305_Load(key +  6) >> 4) & 0x3FFC0FF;
+    ctx->r[3] = (Poly1305_Load(key +  9) >> 6) & 0x3F03FFF;
+    ctx->r[4] = (Poly1305_Load(key + 12) >> 8) & 0x00FFFFF;
+
+    for (int i = 0; i < 5; i++)
+        ctx->h[i] = 0;
+    for (int i = 0; i < 4; i++)
+        ctx->pad[i] = Poly1305_Load(key + 16 + 4 * i);
+
+    ctx->leftover = 0;
+    ctx->final    = 0;
+}
+
+/* h = (h + m) * r mod 2^130 - 5 for each whole block */
+static void Poly1305_Blocks(Poly1305_Ctx_t *ctx, const uint8_t *m, uint32_t len) {
+    const uint32_t hibit = ctx->final ? 0 : (1U << 24);   /* 2^128 */
+    const uint32_t r0 = ctx->r[0], r1 = ctx->r[1], r2 = ctx->r[2], r3 = ctx->r[3], r4 = ctx->r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2], h3 = ctx->h[3], h4 = ctx->h[4];
+
+    while (len >= 16) {
+        uint64_t d0, d1, d2, d3, d4;
+        uint32_t c;
+
+        h0 += (Poly1305_Load(m +  0)     ) & MASK26;
+        h1 += (Poly1305_Load(m +  3) >> 2) & MASK26;
+        h2 += (Poly1305_Load(m +  6) >> 4) & MASK26;
+        h3 += (Poly1305_Load(m +  9) >> 6) & MASK26;
+        h4 += (Poly1305_Load(m + 12) >> 8) | hibit;
+
+        d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+        d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+        d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+        d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+        d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+        c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & MASK26;
+        d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & MASK26;
+        d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & MASK26;
+        d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & MASK26;
+        d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & MASK26;
+        h0 += c * 5; c = h0 >> 26; h0 &= MASK26;
+        h1 += c;
+
+        m   += 16;
+        len -= 16;
+    }
+
+    ctx->h[0] = h0; ctx->h[1] = h1; ctx->h[2] = h2; ctx->h[3] = h3; ctx->h[4] = h4;
+}
+
+void Poly1305_Update(Poly1305_Ctx_t *ctx, const uint8_t *data, uint32_t len) {
+    if (ctx->leftover) {
+        uint32_t want = 16 - ctx->leftover;
+        if (want > len) want = len;
+
+        memcpy(ctx->buffer + ctx->leftover, data, want);
+        ctx->leftover += want;
+        data += want;
+        len  -= want;
+
+        if (ctx->leftover < 16)
+            return;
+        Poly1305_Blocks(ctx, ctx->buffer, 16);
+        ctx->leftover = 0;
+    }
+
+    if (len >= 16) {
+        uint32_t whole = len & ~15U;
+        Poly1305_Blocks(ctx, data, whole);
+        data += whole;
+        len  -= whole;
+    }
+
+    if (len) {
+        memcpy(ctx->buffer, data, len);
+        ctx->leftover = len;
+    }
+}
+
+void Poly1305_Final(Poly1305_Ctx_t *ctx, uint8_t tag[16]) {
+    uint32_t h0, h1, h2, h3, h4, c;
+    uint32_t g0, g1, g2, g3, g4, mask;
+    uint64_t f;
+
+    /* Last partial block: append 1, pad with zeros, no 2^128 bit */
+    if (ctx->leftover) {
+        ctx->buffer[ctx->leftover] = 1;
+        memset(ctx->buffer + ctx->leftover + 1, 0, 15 - ctx->leftover);
+        ctx->final = 1;
+        Poly1305_Blocks(ctx, ctx->buffer, 16);
+    }
+
+    h0 = ctx->h[0]; h1 = ctx->h[1]; h2 = ctx->h[2]; h3 = ctx->h[3]; h4 = ctx->h[4];
+
+    /* Full carry */
+    c = h1 >> 26; h1 &= MASK26;
+    h2 += c; c = h2 >> 26; h2 &= MASK26;
+    h3 += c; c = h3 >> 26; h3 &= MASK26;
+    h4 += c; c = h4 >> 26; h4 &= MASK26;
+    h0 += c * 5; c = h0 >> 26; h0 &= MASK26;
+    h1 += c;
+
+    /* g = h + 5 - 2^130; keep h if that went negative */
+    g0 = h0 + 5; c = g0 >> 26; g0 &= MASK26;
+    g1 = h1 + c; c = g1 >> 26; g1 &= MASK26;
+    g2 = h2 + c; c = g2 >> 26; g2 &= MASK26;
+    g3 = h3 + c; c = g3 >> 26; g3 &= MASK26;
+    g4 = h4 + c - (1U << 26);
+
+    mask = (g4 >> 31) - 1;
+    g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+    mask = ~mask;
+    h0 = (h0 & mask) | g0;
+    h1 = (h1 & mask) | g1;
+    h2 = (h2 & mask) | g2;
+    h3 = (h3 & mask) | g3;
+    h4 = (h4 & mask) | g4;
+
+    /* h = h mod 2^128, as four 32-bit words, then tag = h + s */
+    h0 = (h0      ) | (h1 << 26);
+    h1 = (h1 >>  6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 <<  8);
+
+    f = (uint64_t)h0 + ctx->pad[0];             Poly1305_Store(tag +  0, (uint32_t)f);
+    f = (uint64_t)h1 + ctx->pad[1] + (f >> 32); Poly1305_Store(tag +  4, (uint32_t)f);
+    f = (uint64_t)h2 + ctx->pad[2] + (f >> 32); Poly1305_Store(tag +  8, (uint32_t)f);
+    f = (uint64_t)h3 + ctx->pad[3] + (f >> 32); Poly1305_Store(tag + 12, (uint32_t)f);
+
+    memset(ctx, 0, sizeof(*ctx));
+}
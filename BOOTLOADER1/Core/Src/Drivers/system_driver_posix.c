@@ -0,0 +1,481 @@
+/*
+ * system_driver_posix.c
+ *
+ * Host (Linux / POSIX) platform driver implementing Bootloader_Interface_t
+ * on a flash image file, so the portable bootloader runs unchanged on a
+ * PC. The image is mapped at the target's flash address, which keeps the
+ * memory-mapped reads of the portable layer working as on the MCU.
+ *
+ * Flash follows NOR rules: erase works on whole sectors of the STM32F746
+ * map and sets them to 0xFF, programming can only clear bits. Programming
+ * goes in units of the program width, as STM32_Flash_Write() does: a write
+ * must start on a unit boundary, and only its tail may use narrower units.
+ * Erase and program time is not slept but added to a simulated clock
+ * behind GetTick(), so the timings the bootloader prints are those of the
+ * part; every program unit costs one program operation. The crypto ops
+ * are the software ones, counting the flash bytes they read per slot.
+ *
+ * Environment:
+ *   BL_FLASH_IMAGE             Flash image file        (default flash.bin)
+ *   BL_BUTTON                  1 = button held on the first boot
+ *   BL_SIM_ERASE_US_PER_KB     Erase latency           (default 7800)
+ *   BL_SIM_PROGRAM_US_PER_WORD Latency of one program unit (default 16)
+ *   BL_SIM_PROGRAM_WIDTH       Program unit, 1/2/4/8 bytes (default 4,
+ *                              x32 at 2.7-3.6 V like the STM32 driver)
+ *   BL_SIM_CUT_AT              Cut power during the Nth flash operation
+ *                              (erase or program call, from 1): only the
+ *                              first half of it is done, then the process
+ *                              exits with POSIX_EXIT_CUT
+ *   BL_SIM_RAM_STAGE_SIZE      RAM staging window in bytes, at most
+ *                              RAM_STAGE_SIZE (default); 0 = stage in S7
+ */
+
+#define _GNU_SOURCE
+/* libc first: tiny_printf.h redefines printf */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "system_interface.h"
+#include "system_driver_posix.h"
+#include "tiny_printf.h"
+#include "mem_layout.h"
+#include "crypto_driver_sw.h"
+
+#define FLASH_BASE_ADDR   0x08000000U
+#define FLASH_TOTAL_SIZE  0x00100000U  /* 1 MB */
+#define MAX_RESETS        16
+
+/* STM32F746 sector boundaries, last entry is the end of flash */
+static const uint32_t sector_start[] = {
+    0x08000000, 0x08008000, 0x08010000, 0x08018000, 0x08020000,
+    0x08040000, 0x08080000, 0x080C0000, 0x08100000
+};
+#define SECTOR_COUNT  (sizeof(sector_start) / sizeof(sector_start[0]) - 1)
+
+jmp_buf posix_reset_point;
+
+static uint8_t *flash;
+static uint32_t boot_count;
+static uint64_t start_us;
+static uint64_t flash_busy_us;
+static uint32_t erase_us_per_kb     = 7800;
+static uint32_t program_us_per_word = 16;
+static uint32_t program_width       = 4;
+static uint32_t cut_at;
+static uint32_t flash_ops;
+
+static uint32_t erase_count;
+static uint32_t program_calls;
+static uint64_t programmed_bytes;
+
+/* Flash bytes hashed, MACed or decrypted, per sector */
+static uint64_t crypto_reads[SECTOR_COUNT];
+
+/* Erases, per sector */
+static uint32_t sector_erases[SECTOR_COUNT];
+
+/* Defined at the end of the file */
+static Bootloader_Interface_t posix_interface;
+
+/* ===== Helpers ===== */
+
+static uint64_t Posix_Now_Us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+static uint32_t Posix_Env(const char *name, uint32_t fallback) {
+    const char *value = getenv(name);
+    return value ? (uint32_t)strtoul(value, NULL, 0) : fallback;
+}
+
+static void Posix_Report(void) {
+    fprintf(stderr, "[SIM] %u boot(s), %u sector erases, %llu bytes programmed in %u calls, "
+            "%llu ms flash busy\n", (unsigned int)boot_count, (unsigned int)erase_count,
+            (unsigned long long)programmed_bytes, (unsigned int)program_calls,
+            (unsigned long long)(flash_busy_us / 1000U));
+    fprintf(stderr, "[SIM] Read by crypto ops: S5 %llu, S6 %llu, S7 %llu bytes\n",
+            (unsigned long long)crypto_reads[5], (unsigned long long)crypto_reads[6],
+            (unsigned long long)crypto_reads[7]);
+    fprintf(stderr, "[SIM] Sector erases: S5 %u, S6 %u, S7 %u\n",
+            (unsigned int)sector_erases[5], (unsigned int)sector_erases[6],
+            (unsigned int)sector_erases[7]);
+}
+
+static void Posix_Map_Flash(void) {
+    const char *path = getenv("BL_FLASH_IMAGE");
+    if (!path) path = "flash.bin";
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(path);
+        exit(POSIX_EXIT_HALT);
+    }
+
+    /* A new or short image gets erased flash appended */
+    if ((uint64_t)st.st_size < FLASH_TOTAL_SIZE) {
+        static uint8_t erased[4096];
+        memset(erased, 0xFF, sizeof(erased));
+        lseek(fd, 0, SEEK_END);
+        for (uint64_t size = st.st_size; size < FLASH_TOTAL_SIZE; ) {
+            uint64_t n = FLASH_TOTAL_SIZE - size;
+            if (n > sizeof(erased)) n = sizeof(erased);
+            if (write(fd, erased, n) != (ssize_t)n) {
+                perror(path);
+                exit(POSIX_EXIT_HALT);
+            }
+            size += n;
+        }
+    }
+
+    flash = mmap((void *)(uintptr_t)FLASH_BASE_ADDR, FLASH_TOTAL_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    close(fd);
+
+    if (flash != (uint8_t *)(uintptr_t)FLASH_BASE_ADDR) {
+        perror("mmap flash");
+        exit(POSIX_EXIT_HALT);
+    }
+}
+
+/* The RAM staging window, at its address on the target */
+static void Posix_Map_Ram(void) {
+#if RAM_STAGE_SIZE
+    void *ram = mmap((void *)(uintptr_t)RAM_STAGE_ADDR, RAM_STAGE_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (ram != (void *)(uintptr_t)RAM_STAGE_ADDR) {
+        perror("mmap ram");
+        exit(POSIX_EXIT_HALT);
+    }
+#endif
+}
+
+/* ===== System Control ===== */
+
+static void Posix_Init(void) {
+    if (flash == NULL) {
+        erase_us_per_kb     = Posix_Env("BL_SIM_ERASE_US_PER_KB", erase_us_per_kb);
+        program_us_per_word = Posix_Env("BL_SIM_PROGRAM_US_PER_WORD", program_us_per_word);
+        program_width       = Posix_Env("BL_SIM_PROGRAM_WIDTH", program_width);
+        if (program_width != 1 && program_width != 2 && program_width != 4 && program_width != 8)
+            program_width = 4;
+        cut_at              = Posix_Env("BL_SIM_CUT_AT", 0);
+        posix_interface.mem.ram_stage_size = Posix_Env("BL_SIM_RAM_STAGE_SIZE", RAM_STAGE_SIZE);
+        if (posix_interface.mem.ram_stage_size > RAM_STAGE_SIZE)
+            posix_interface.mem.ram_stage_size = RAM_STAGE_SIZE;
+        start_us = Posix_Now_Us();
+        Posix_Map_Flash();
+        Posix_Map_Ram();
+        atexit(Posix_Report);
+    }
+    boot_count++;
+}
+
+static void Posix_DeInit(void) {
+    msync(flash, FLASH_TOTAL_SIZE, MS_SYNC);
+}
+
+static void Posix_SystemReset(void) {
+    fflush(stdout);
+    if (boot_count >= MAX_RESETS) {
+        fprintf(stderr, "[SIM] Reset loop, giving up after %u boots\n", (unsigned int)boot_count);
+        exit(POSIX_EXIT_RESET_LOOP);
+    }
+#if RAM_STAGE_SIZE
+    /* The bootloader must not rely on anything staged before the reset */
+    memset((void *)(uintptr_t)RAM_STAGE_ADDR, 0xA5, RAM_STAGE_SIZE);
+#endif
+    longjmp(posix_reset_point, 1);
+}
+
+static void Posix_Delay(uint32_t ms) {
+    flash_busy_us += (uint64_t)ms * 1000U;
+}
+
+/* Wall-clock time plus the modelled flash latency */
+static uint32_t Posix_GetTick(void) {
+    return (uint32_t)((Posix_Now_Us() - start_us + flash_busy_us) / 1000U);
+}
+
+/* ===== Communication ===== */
+
+static void Posix_UART_Write(const uint8_t *data, uint16_t size) {
+    fwrite(data, 1, size, stdout);
+}
+
+/* ===== GPIO ===== */
+
+static uint8_t Posix_ReadButton(void) {
+    return (boot_count == 1 && Posix_Env("BL_BUTTON", 0) == 1) ? 1 : 0;
+}
+
+static void Posix_ToggleLed(void) {
+}
+
+/* ===== Flash ===== */
+
+/* Counts a flash operation; 1 if power is cut during this one */
+static uint8_t Posix_Cut_Now(void) {
+    return ++flash_ops == cut_at;
+}
+
+static void Posix_Cut(uint32_t addr) {
+    fprintf(stderr, "[SIM] Power cut during flash operation %u at 0x%08X\n",
+            (unsigned int)flash_ops, (unsigned int)addr);
+    fflush(stdout);
+    msync(flash, FLASH_TOTAL_SIZE, MS_SYNC);
+    exit(POSIX_EXIT_CUT);
+}
+
+static int Posix_Flash_Erase(uint32_t start_addr, uint32_t length) {
+    if (start_addr < FLASH_BASE_ADDR || length == 0 ||
+        start_addr - FLASH_BASE_ADDR + length > FLASH_TOTAL_SIZE)
+        return -1;
+
+    uint8_t cut = Posix_Cut_Now();
+    for (uint32_t i = 0; i < SECTOR_COUNT; i++) {
+        if (sector_start[i + 1] <= start_addr || sector_start[i] >= start_addr + length)
+            continue;
+
+        uint32_t size = sector_start[i + 1] - sector_start[i];
+        if (cut) {
+            /* An interrupted erase leaves the sector neither old nor erased */
+            memset(flash + (sector_start[i] - FLASH_BASE_ADDR), 0xFF, size / 2U);
+            Posix_Cut(sector_start[i]);
+        }
+        memset(flash + (sector_start[i] - FLASH_BASE_ADDR), 0xFF, size);
+        flash_busy_us += (uint64_t)(size / 1024U) * erase_us_per_kb;
+        erase_count++;
+        sector_erases[i]++;
+    }
+    return 0;
+}
+
+/*
+ * Programming can only clear bits; anything else is an error on real NOR.
+ * A start off the unit boundary would make the target fall back to
+ * narrower units for the whole run, so it is refused here.
+ */
+static int Posix_Flash_Write(uint32_t addr, const uint8_t *data, uint32_t length) {
+    program_calls++;
+    if (addr < FLASH_BASE_ADDR || addr - FLASH_BASE_ADDR + length > FLASH_TOTAL_SIZE)
+        return -1;
+
+    if ((addr & (program_width - 1U)) != 0) {
+        fprintf(stderr, "[SIM] Program error at 0x%08X: not aligned to the %u-byte program unit\n",
+                (unsigned int)addr, (unsigned int)program_width);
+        return -1;
+    }
+
+    /* A cut call programs its first half of units */
+    uint8_t cut = Posix_Cut_Now();
+    uint32_t done = cut ? (length / 2U) & ~(program_width - 1U) : length;
+
+    uint8_t *dest = flash + (addr - FLASH_BASE_ADDR);
+    for (uint32_t i = 0; i < done; i++) {
+        if ((dest[i] & data[i]) != data[i]) {
+            fprintf(stderr, "[SIM] Program error at 0x%08X: 0x%02X over 0x%02X\n",
+                    (unsigned int)(addr + i), data[i], dest[i]);
+            return -1;
+        }
+        dest[i] = data[i];
+    }
+    if (cut)
+        Posix_Cut(addr + done);
+
+    /* Whole units, then the tail halving down like STM32_Flash_Write() */
+    uint32_t units = length / program_width;
+    uint32_t tail  = length % program_width;
+    for (uint32_t width = program_width / 2U; tail != 0; width /= 2U) {
+        if (tail >= width) {
+            units++;
+            tail -= width;
+        }
+    }
+
+    flash_busy_us += (uint64_t)units * program_us_per_word;
+    programmed_bytes += length;
+    return 0;
+}
+
+/* ===== Crypto ===== */
+
+/*
+ * Charges a crypto input to the sector it starts in, if it lies in flash.
+ * A range read again straight away (hashed, then decrypted) counts once.
+ */
+static void Posix_Count_Read(const uint8_t *data, uint32_t len) {
+    static const uint8_t *last_data;
+    static uint32_t last_len;
+    uint32_t addr = (uint32_t)(uintptr_t)data;
+
+    if ((uintptr_t)data != addr || (data == last_data && len == last_len))
+        return;
+    last_data = data;
+    last_len  = len;
+    for (uint32_t i = 0; i < SECTOR_COUNT; i++) {
+        if (addr >= sector_start[i] && addr < sector_start[i + 1]) {
+            crypto_reads[i] += len;
+            return;
+        }
+    }
+}
+
+static int Posix_AES_CBC_Decrypt(const BL_AesCtx_t *ctx, const uint8_t iv[16],
+                                 const uint8_t *in, uint8_t *out, uint32_t len) {
+    Posix_Count_Read(in, len);
+    return SW_AES_CBC_Decrypt(ctx, iv, in, out, len);
+}
+
+static int Posix_AES_ECB_Encrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len) {
+    Posix_Count_Read(in, len);
+    return SW_AES_ECB_Encrypt(ctx, in, out, len);
+}
+
+static int Posix_AES_ECB_Decrypt(const BL_AesCtx_t *ctx, const uint8_t *in, uint8_t *out, uint32_t len) {
+    Posix_Count_Read(in, len);
+    return SW_AES_ECB_Decrypt(ctx, in, out, len);
+}
+
+static int Posix_AES_CTR_Xor(const BL_AesCtx_t *ctx, const uint8_t ctr[16],
+                             const uint8_t *in, uint8_t *out, uint32_t len) {
+    Posix_Count_Read(in, len);
+    return SW_AES_CTR_Xor(ctx, ctr, in, out, len);
+}
+
+static int Posix_CHACHA20_Xor(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+                              const uint8_t *in, uint8_t *out, uint32_t len) {
+    Posix_Count_Read(in, len);
+    return SW_CHACHA20_Xor(key, nonce, counter, in, out, len);
+}
+
+static int Posix_POLY1305_Update(BL_PolyCtx_t *ctx, const uint8_t *data, uint32_t len) {
+    Posix_Count_Read(data, len);
+    return SW_POLY1305_Update(ctx, data, len);
+}
+
+static int Posix_SHA256(const uint8_t *data, uint32_t len, uint8_t digest[32]) {
+    Posix_Count_Read(data, len);
+    return SW_SHA256(data, len, digest);
+}
+
+static int Posix_SHA256_Update(BL_HashCtx_t *ctx, const uint8_t *data, uint32_t len) {
+    Posix_Count_Read(data, len);
+    return SW_SHA256_Update(ctx, data, len);
+}
+
+/* ===== Error Handling ===== */
+
+static void Posix_ErrorHandler(void) {
+    fflush(stdout);
+    exit(POSIX_EXIT_HALT);
+}
+
+/* ===== Interrupt Control ===== */
+
+static void Posix_DisableIRQ(void) {
+}
+
+static void Posix_EnableIRQ(void) {
+}
+
+/* ===== Application Jump ===== */
+
+static void Posix_JumpToApp(uint32_t app_addr) {
+    uint32_t app_stack_addr    = *(volatile uint32_t *)app_addr;
+    uint32_t app_reset_handler = *(volatile uint32_t *)(app_addr + 4);
+
+    if ((app_stack_addr & 0x20000000) != 0x20000000)
+        return;
+
+    printf("[SIM] Jump to application at 0x%X: SP=0x%X PC=0x%X\r\n", (unsigned int)app_addr,
+           (unsigned int)app_stack_addr, (unsigned int)app_reset_handler);
+    Posix_DeInit();
+    fflush(stdout);
+    exit(POSIX_EXIT_APP);
+}
+
+/* ===== Console ===== */
+
+void tfp_init(void *handle) {
+    (void)handle;
+}
+
+void tfp_printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+/* ===== Interface Definition ===== */
+
+/* Not const: Init sizes the RAM staging window from the environment */
+static Bootloader_Interface_t posix_interface = {
+    .mem = {
+        .config_addr       = CONFIG_SECTOR_ADDR,
+        .config_size       = CONFIG_SECTOR_SIZE,
+        .config_alt_addr   = CONFIG_ALT_SECTOR_ADDR,
+        .app_active_addr   = APP_ACTIVE_START_ADDR,
+        .app_download_addr = APP_DOWNLOAD_START_ADDR,
+        .scratch_addr      = SCRATCH_ADDR,
+        .slot_size         = SLOT_SIZE,
+        .sector_size       = SLOT_SECTOR_SIZE,
+        .flash_base        = FLASH_BASE_ADDR,
+        .ram_base          = 0x20000000,
+        .ram_stage_addr    = RAM_STAGE_ADDR,
+        .ram_stage_size    = RAM_STAGE_SIZE,
+    },
+
+    .crypto = {
+        .AES_EncryptBlock = SW_AES_EncryptBlock,
+        .AES_DecryptBlock = SW_AES_DecryptBlock,
+        .AES_Init         = SW_AES_Init,
+        .AES_CBC_Decrypt  = Posix_AES_CBC_Decrypt,
+        .AES_ECB_Encrypt  = Posix_AES_ECB_Encrypt,
+        .AES_ECB_Decrypt  = Posix_AES_ECB_Decrypt,
+        .AES_CTR_Xor      = Posix_AES_CTR_Xor,
+        .CHACHA20_Xor     = Posix_CHACHA20_Xor,
+        .POLY1305_Init    = SW_POLY1305_Init,
+        .POLY1305_Update  = Posix_POLY1305_Update,
+        .POLY1305_Final   = SW_POLY1305_Final,
+        .SHA256           = Posix_SHA256,
+        .SHA256_Init      = SW_SHA256_Init,
+        .SHA256_Update    = Posix_SHA256_Update,
+        .SHA256_Final     = SW_SHA256_Final,
+        .ECDSA_Verify     = SW_ECDSA_Verify,
+    },
+
+    .Init              = Posix_Init,
+    .DeInit            = Posix_DeInit,
+    .SystemReset       = Posix_SystemReset,
+    .Delay             = Posix_Delay,
+    .GetTick           = Posix_GetTick,
+
+    .UART_Write        = Posix_UART_Write,
+
+    .GPIO_ReadUserButton = Posix_ReadButton,
+    .GPIO_ToggleLed    = Posix_ToggleLed,
+
+    .Flash_Unlock      = NULL,
+    .Flash_Lock        = NULL,
+    .Flash_Erase       = Posix_Flash_Erase,
+    .Flash_Write       = Posix_Flash_Write,
+
+    .ErrorHandler      = Posix_ErrorHandler,
+    .JumpToApp         = Posix_JumpToApp,
+    .DisableIRQ        = Posix_DisableIRQ,
+    .EnableIRQ         = Posix_EnableIRQ,
+};
+
+const Bootloader_Interface_t* Sys_GetInterface(void) {
+    return &posix_interface;
+}
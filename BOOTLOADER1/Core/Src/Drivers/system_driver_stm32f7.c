@@ -14,14 +14,47 @@
 #include "tiny_printf.h"
 #include "mem_layout.h"
 #include "crypto_driver_sw.h"
+#include <string.h>
 
 extern UART_HandleTypeDef huart1;
 extern void Error_Handler(void);
 
+/* Linker script symbols (CubeMX layout); their addresses are the values */
+extern uint8_t _ebss[];
+extern uint8_t _estack[];
+extern uint8_t _Min_Stack_Size[];
+
+/* Defined at the end of the file */
+static Bootloader_Interface_t stm32f7_interface;
+
 /* ===== System Control ===== */
 
+/*
+ * mem_layout.h requires .data/.bss below the RAM staging window and the
+ * stack above it. A linker script that breaks this would have the staged
+ * image overwrite live data, so staging falls back to sector 7.
+ */
+static void STM32_Check_Ram_Stage(void) {
+    uint32_t stage_end = RAM_STAGE_ADDR + RAM_STAGE_SIZE;
+    uint32_t bss_end   = (uint32_t)_ebss;
+    uint32_t stack_top = (uint32_t)_estack;
+    uint32_t stack_low = stack_top - (uint32_t)_Min_Stack_Size;
+
+    if (RAM_STAGE_SIZE == 0)
+        return;
+
+    if (bss_end > RAM_STAGE_ADDR || (stack_low < stage_end && stack_top > RAM_STAGE_ADDR)) {
+        stm32f7_interface.mem.ram_stage_size = 0;
+        printf("[BL] Warning: RAM stage 0x%X-0x%X overlaps .bss (end 0x%X) or stack (0x%X-0x%X).\r\n",
+               (unsigned int)RAM_STAGE_ADDR, (unsigned int)stage_end, (unsigned int)bss_end,
+               (unsigned int)stack_low, (unsigned int)stack_top);
+        printf("[BL] Updates will be staged in Sector 7.\r\n");
+    }
+}
+
 static void STM32_Init(void) {
     tfp_init(&huart1);
+    STM32_Check_Ram_Stage();
 }
 
 static void STM32_DeInit(void) {
@@ -60,17 +93,53 @@ static void STM32_GPIO_ToggleLed(void) {
 
 static uint32_t GetSector(uint32_t address) {
     if (address >= 0x08000000 && address < 0x08008000) return FLASH_SECTOR_0;
+    if (address >= 0x08008000 && address < 0x08010000) return FLASH_SECTOR_1;
+    if (address >= 0x08010000 && address < 0x08018000) return FLASH_SECTOR_2;
+    if (address >= 0x08018000 && address < 0x08020000) return FLASH_SECTOR_3;
+    if (address >= 0x08020000 && address < 0x08040000) return FLASH_SECTOR_4;
     if (address >= 0x08040000 && address < 0x08080000) return FLASH_SECTOR_5;
     if (address >= 0x08080000 && address < 0x080C0000) return FLASH_SECTOR_6;
     if (address >= 0x080C0000 && address < 0x08100000) return FLASH_SECTOR_7;
     return FLASH_SECTOR_7;
 }
 
+/*
+ * Program parallelism is limited by the supply voltage (RM0385 §3.3.2):
+ * x8 at 1.8–2.1 V, x16 at 2.1–2.7 V, x32 at 2.7–3.6 V and x64 only with
+ * an external Vpp.  The same range is used for sector erase.
+ */
+#define FLASH_VOLTAGE_RANGE  FLASH_VOLTAGE_RANGE_3
+
+/* Set while the portable layer holds flash unlocked across many writes */
+static uint8_t flash_held = 0;
+
+static uint32_t Flash_MaxProgramWidth(void) {
+    switch (FLASH_VOLTAGE_RANGE) {
+        case FLASH_VOLTAGE_RANGE_4: return 8;
+        case FLASH_VOLTAGE_RANGE_3: return 4;
+        case FLASH_VOLTAGE_RANGE_2: return 2;
+        default:                    return 1;
+    }
+}
+
+static int Flash_Acquire(void) {
+    if (flash_held)
+        return 0;
+    return (HAL_FLASH_Unlock() == HAL_OK) ? 0 : -1;
+}
+
+static void Flash_Release(void) {
+    if (!flash_held)
+        HAL_FLASH_Lock();
+}
+
 static void STM32_Flash_Unlock(void) {
-    HAL_FLASH_Unlock();
+    if (HAL_FLASH_Unlock() == HAL_OK)
+        flash_held = 1;
 }
 
 static void STM32_Flash_Lock(void) {
+    flash_held = 0;
     HAL_FLASH_Lock();
 }
 
@@ -78,38 +147,64 @@ static int STM32_Flash_Erase(uint32_t address, uint32_t length) {
     FLASH_EraseInitTypeDef erase_init;
     uint32_t sector_error;
 
-    if (HAL_FLASH_Unlock() != HAL_OK)
+    if (Flash_Acquire() != 0)
         return -1;
 
     uint32_t first_sector = GetSector(address);
     uint32_t last_sector  = GetSector(address + length - 1);
 
     erase_init.TypeErase    = FLASH_TYPEERASE_SECTORS;
-    erase_init.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    erase_init.VoltageRange = FLASH_VOLTAGE_RANGE;
     erase_init.Sector       = first_sector;
     erase_init.NbSectors    = last_sector - first_sector + 1;
 
     if (HAL_FLASHEx_Erase(&erase_init, &sector_error) != HAL_OK) {
-        HAL_FLASH_Lock();
+        Flash_Release();
         return -1;
     }
 
-    HAL_FLASH_Lock();
+    Flash_Release();
     return 0;
 }
 
+/*
+ * Programs with the widest unit the voltage range allows.  Unaligned
+ * heads and short tails fall back to narrower units, so any address and
+ * length are accepted.
+ */
 static int STM32_Flash_Write(uint32_t address, const uint8_t *data, uint32_t length) {
-    if (HAL_FLASH_Unlock() != HAL_OK)
+    uint32_t max_width = Flash_MaxProgramWidth();
+
+    if (Flash_Acquire() != 0)
         return -1;
 
-    for (uint32_t i = 0; i < length; i++) {
-        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, address + i, data[i]) != HAL_OK) {
-            HAL_FLASH_Lock();
+    while (length > 0) {
+        uint32_t type  = FLASH_TYPEPROGRAM_BYTE;
+        uint32_t width = 1;
+        uint64_t value = 0;
+
+        if (max_width >= 8 && (address & 7U) == 0 && length >= 8) {
+            type = FLASH_TYPEPROGRAM_DOUBLEWORD; width = 8;
+        } else if (max_width >= 4 && (address & 3U) == 0 && length >= 4) {
+            type = FLASH_TYPEPROGRAM_WORD;       width = 4;
+        } else if (max_width >= 2 && (address & 1U) == 0 && length >= 2) {
+            type = FLASH_TYPEPROGRAM_HALFWORD;   width = 2;
+        }
+
+        /* Source may be unaligned (RAM buffers, other flash slots) */
+        memcpy(&value, data, width);
+
+        if (HAL_FLASH_Program(type, address, value) != HAL_OK) {
+            Flash_Release();
             return -1;
         }
+
+        address += width;
+        data    += width;
+        length  -= width;
     }
 
-    HAL_FLASH_Lock();
+    Flash_Release();
     return 0;
 }
 
@@ -127,8 +222,7 @@ static void STM32_EnableIRQ(void) {
     __enable_irq();
 }
 
-static void STM32_JumpToApp(void) {
-    uint32_t app_addr = APP_ACTIVE_START_ADDR;
+static void STM32_JumpToApp(uint32_t app_addr) {
     uint32_t app_stack_addr = *(volatile uint32_t *)app_addr;
     uint32_t app_reset_handler = *(volatile uint32_t *)(app_addr + 4);
 
@@ -158,21 +252,39 @@ static void STM32_JumpToApp(void) {
 
 /* ===== Interface Definition ===== */
 
-static const Bootloader_Interface_t stm32f7_interface = {
+/* Not const: Init drops the RAM staging window if the linker map overlaps it */
+static Bootloader_Interface_t stm32f7_interface = {
     .mem = {
         .config_addr       = CONFIG_SECTOR_ADDR,
+        .config_size       = CONFIG_SECTOR_SIZE,
+        .config_alt_addr   = CONFIG_ALT_SECTOR_ADDR,
         .app_active_addr   = APP_ACTIVE_START_ADDR,
         .app_download_addr = APP_DOWNLOAD_START_ADDR,
         .scratch_addr      = SCRATCH_ADDR,
         .slot_size         = SLOT_SIZE,
+        .sector_size       = SLOT_SECTOR_SIZE,
         .flash_base        = 0x08000000,
         .ram_base          = 0x20000000,
+        .ram_stage_addr    = RAM_STAGE_ADDR,
+        .ram_stage_size    = RAM_STAGE_SIZE,
     },
 
     .crypto = {
         .AES_EncryptBlock = SW_AES_EncryptBlock,
         .AES_DecryptBlock = SW_AES_DecryptBlock,
+        .AES_Init         = SW_AES_Init,
+        .AES_CBC_Decrypt  = SW_AES_CBC_Decrypt,
+        .AES_ECB_Encrypt  = SW_AES_ECB_Encrypt,
+        .AES_ECB_Decrypt  = SW_AES_ECB_Decrypt,
+        .AES_CTR_Xor      = SW_AES_CTR_Xor,
+        .CHACHA20_Xor     = SW_CHACHA20_Xor,
+        .POLY1305_Init    = SW_POLY1305_Init,
+        .POLY1305_Update  = SW_POLY1305_Update,
+        .POLY1305_Final   = SW_POLY1305_Final,
         .SHA256           = SW_SHA256,
+        .SHA256_Init      = SW_SHA256_Init,
+        .SHA256_Update    = SW_SHA256_Update,
+        .SHA256_Final     = SW_SHA256_Final,
         .ECDSA_Verify     = SW_ECDSA_Verify,
     },
 
@@ -82,7 +82,8 @@ static int MCU_Flash_Write(uint32_t address, const uint8_t *data, uint32_t lengt
      *
      * Steps:
      *   1. Unlock flash
-     *   2. Program byte-by-byte (or word-by-word if your HAL requires alignment)
+     *   2. Program with the widest unit your flash allows (word/double-word),
+     *      falling back to narrower units for unaligned heads and tails
      *   3. Lock flash
      *   4. Return 0 on success, -1 on failure
      */
@@ -106,18 +107,19 @@ static void MCU_EnableIRQ(void) {
     __enable_irq();
 }
 
-static void MCU_JumpToApp(void) {
-    /* TODO: jump to the application.
+static void MCU_JumpToApp(uint32_t app_addr) {
+    /* TODO: jump to the application whose vector table is at app_addr
+     * (APP_ACTIVE_START_ADDR, or either slot with BL_XIP_AB).
      *
      * Required steps (Cortex-M):
-     *   1. Read stack pointer  = *(uint32_t *)(APP_ACTIVE_START_ADDR + 0)
-     *   2. Read reset handler  = *(uint32_t *)(APP_ACTIVE_START_ADDR + 4)
+     *   1. Read stack pointer  = *(uint32_t *)(app_addr + 0)
+     *   2. Read reset handler  = *(uint32_t *)(app_addr + 4)
      *   3. Validate SP — upper byte must match your MCU's RAM base
      *   4. Disable MPU (if used), stop SysTick
      *   5. Disable all IRQs: NVIC->ICER[0..7] = 0xFFFFFFFF
      *   6. Clear pending IRQs: NVIC->ICPR[0..7] = 0xFFFFFFFF
      *   7. Call HAL_DeInit() or equivalent
-     *   8. SCB->VTOR = APP_ACTIVE_START_ADDR
+     *   8. SCB->VTOR = app_addr
      *   9. __set_MSP(stack_pointer)
      *  10. Call reset_handler()
      *
@@ -131,12 +133,17 @@ static const Bootloader_Interface_t mcu_interface = {
     /* --- Memory layout (values from mem_layout.h) --- */
     .mem = {
         .config_addr       = CONFIG_SECTOR_ADDR,
+        .config_size       = CONFIG_SECTOR_SIZE,
+        .config_alt_addr   = CONFIG_ALT_SECTOR_ADDR,
         .app_active_addr   = APP_ACTIVE_START_ADDR,
         .app_download_addr = APP_DOWNLOAD_START_ADDR,
         .scratch_addr      = SCRATCH_ADDR,
         .slot_size         = SLOT_SIZE,
+        .sector_size       = SLOT_SECTOR_SIZE,
         .flash_base        = 0x00000000,   /* TODO: your MCU's flash base address */
         .ram_base          = 0x00000000,   /* TODO: your MCU's RAM  base address  */
+        .ram_stage_addr    = 0x00000000,   /* Optional: free RAM to stage updates */
+        .ram_stage_size    = 0,            /* 0 = stage in the scratch slot       */
     },
 
     /* --- Cryptography ---
@@ -148,7 +155,19 @@ static const Bootloader_Interface_t mcu_interface = {
     .crypto = {
         .AES_EncryptBlock = SW_AES_EncryptBlock,
         .AES_DecryptBlock = SW_AES_DecryptBlock,
+        .AES_Init         = SW_AES_Init,
+        .AES_CBC_Decrypt  = SW_AES_CBC_Decrypt,
+        .AES_ECB_Encrypt  = SW_AES_ECB_Encrypt,
+        .AES_ECB_Decrypt  = SW_AES_ECB_Decrypt,
+        .AES_CTR_Xor      = SW_AES_CTR_Xor,
+        .CHACHA20_Xor     = SW_CHACHA20_Xor,
+        .POLY1305_Init    = SW_POLY1305_Init,
+        .POLY1305_Update  = SW_POLY1305_Update,
+        .POLY1305_Final   = SW_POLY1305_Final,
         .SHA256           = SW_SHA256,
+        .SHA256_Init      = SW_SHA256_Init,
+        .SHA256_Update    = SW_SHA256_Update,
+        .SHA256_Final     = SW_SHA256_Final,
         .ECDSA_Verify     = SW_ECDSA_Verify,
     },
 
@@ -164,7 +183,8 @@ static const Bootloader_Interface_t mcu_interface = {
     .GPIO_ReadUserButton = MCU_GPIO_ReadUserButton,
     .GPIO_ToggleLed    = MCU_GPIO_ToggleLed,
 
-    .Flash_Unlock      = NULL,   /* unlock/lock are called internally by Erase/Write */
+    .Flash_Unlock      = NULL,   /* optional: hold flash unlocked across a pass;      */
+                                 /* Erase/Write must still unlock/lock on their own  */
     .Flash_Lock        = NULL,
     .Flash_Erase       = MCU_Flash_Erase,
     .Flash_Write       = MCU_Flash_Write,
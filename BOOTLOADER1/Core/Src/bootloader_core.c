@@ -14,11 +14,42 @@
 #include "Cryptology_Control.h"
 #include "firmware_footer.h"
 #include "tiny_printf.h"
+#include <stddef.h>
+
+#if BL_XIP_AB
+/*
+ * Both slots hold images linked to run in place, so an update or a
+ * rollback only moves the pointer to the slot that is started.
+ */
+static void Bootloader_Run_Xip(const Bootloader_Interface_t *sys, BootConfig_t *config) {
+    uint32_t state = config->system_status;
+
+    if (sys->GPIO_ReadUserButton() == 1) {
+        printf("[BL] Button Pressed! Switching to the other slot...\r\n");
+        state = STATE_ROLLBACK;
+    }
+
+    uint32_t slot = BL_Xip_Select(config, state);
+    if (slot == 0) {
+        printf("[ERROR] No valid image in S5 or S6.\r\n");
+        printf("[ERROR] System Halted.\r\n");
+        sys->ErrorHandler();
+        return;
+    }
+
+    printf("[BL] Running in place from 0x%X (version 0x%X). Jumping...\r\n",
+           (unsigned int)slot, (unsigned int)config->current_version);
+    sys->JumpToApp(slot);
+}
+#endif
 
 void Bootloader_Run(const Bootloader_Interface_t *sys) {
     BootConfig_t config;
     const BL_MemoryMap_t *mem = &sys->mem;
 
+    /* Package footer found in S6 by the button check; the swap verifies it */
+    uint32_t s6_footer = 0;
+
     sys->Init();
     BL_SetInterface(sys);
 
@@ -31,14 +62,25 @@ void Bootloader_Run(const Bootloader_Interface_t *sys) {
         BL_WriteConfig(&config);
     }
 
-    /* Check User Button */
-    if (sys->GPIO_ReadUserButton() == 1) {
+#if BL_XIP_AB
+    Bootloader_Run_Xip(sys, &config);
+    return;
+#endif
+
+    if (BL_Swap_Pending(&config)) {
+        /* An interrupted swap must finish before anything else runs */
+        printf("[BL] Interrupted swap found. Resuming...\r\n");
+        config.system_status = (config.swap.flags & BL_SWAP_ROLLBACK) ? STATE_ROLLBACK
+                                                                      : STATE_UPDATE_REQ;
+    } else if (sys->GPIO_ReadUserButton() == 1) {
+        /* Check User Button */
         printf("[BL] Button Pressed! Determining Mode...\r\n");
 
-        FW_Status_t status = Firmware_Is_Valid(mem->app_download_addr, mem->slot_size, &sys->crypto);
+        /* Only located here: the install checks the signature in its one pass */
+        s6_footer = Firmware_Locate(mem->app_download_addr, mem->slot_size);
 
-        if (status == BL_OK) {
-            printf(" -> Valid Footer Found. Requesting UPDATE.\r\n");
+        if (s6_footer) {
+            printf(" -> Update Package Found. Requesting UPDATE.\r\n");
             config.system_status = STATE_UPDATE_REQ;
         } else {
             uint32_t *s6_ptr = (uint32_t *)mem->app_download_addr;
@@ -56,15 +98,29 @@ void Bootloader_Run(const Bootloader_Interface_t *sys) {
     switch (config.system_status) {
         case STATE_UPDATE_REQ:
             printf("[BL] State: UPDATE REQUESTED.\r\n");
-            BL_Swap_NoBuffer();
+            BL_Swap_NoBuffer(s6_footer);
+
+            BL_ReadConfig(&config);
+            if (BL_Swap_Pending(&config)) {
+                printf("[BL] Update Interrupted. Retrying after reset.\r\n");
+                sys->SystemReset();
+            }
 
             printf("[BL] Update Process Finished/Failed. Clearing state.\r\n");
             config.system_status = STATE_NORMAL;
             BL_WriteConfig(&config);
+
+            /* Boot whatever S5 holds now, instead of waiting for a manual reset */
+            sys->SystemReset();
             break;
 
         case STATE_ROLLBACK:
             if (BL_Rollback() != BL_OK) {
+                BL_ReadConfig(&config);
+                if (BL_Swap_Pending(&config)) {
+                    printf("[BL] Rollback Interrupted. Retrying after reset.\r\n");
+                    sys->SystemReset();
+                }
                 printf("[BL] Rollback Failed. Reverting state to NORMAL.\r\n");
                 config.system_status = STATE_NORMAL;
                 BL_WriteConfig(&config);
@@ -84,12 +140,13 @@ void Bootloader_Run(const Bootloader_Interface_t *sys) {
             {
                 printf("[BL] Valid App found at 0x%X. Jumping...\r\n",
                        (unsigned int)mem->app_active_addr);
-                sys->JumpToApp();
+                sys->JumpToApp(mem->app_active_addr);
             } else {
                 printf("[BL] S5 Empty or Invalid! Checking S6 for Auto-Provisioning...\r\n");
 
-                if (Firmware_Is_Valid(mem->app_download_addr, mem->slot_size, &sys->crypto) == BL_OK) {
-                    printf("[BL] Valid Image found in S6! Triggering Update...\r\n");
+                /* The update verifies the package; a bad one is erased there */
+                if (Firmware_Locate(mem->app_download_addr, mem->slot_size)) {
+                    printf("[BL] Update Package found in S6! Triggering Update...\r\n");
                     config.system_status = STATE_UPDATE_REQ;
                     BL_WriteConfig(&config);
                     sys->SystemReset();
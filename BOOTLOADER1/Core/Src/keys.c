@@ -21,6 +21,7 @@
 /**
  * @brief  AES-128 Secret Key (16 Bytes).
  * @note   Used for AES-CBC (Update Decryption) and AES-ECB (Backup Encryption).
+ * The ChaCha20 key is derived from it (see FW_CHACHA20_KEY_LABEL).
  * Generated by keygen.py.
  */
 const uint8_t AES_SECRET_KEY[16] = {
@@ -49,3 +50,151 @@ const uint8_t ECDSA_public_key_xy[64] = {
 	0xA8, 0xE6, 0x29, 0x5C, 0xDE, 0x3C, 0x7C, 0x34,
 	0xC2, 0xE2, 0xBE, 0xD9, 0x17, 0x38, 0xFF, 0xA5
 };
+
+// ============================================================================
+// 3. ECDSA PUBLIC KEY COMB TABLE
+// ============================================================================
+/**
+ * @brief  Precomputed multiples of the public key for ECDSA_Comb_Verify().
+ * @note   Must be regenerated together with ECDSA_public_key_xy; the
+ * verifier falls back to uECC_verify() if public_key does not match.
+ * Generated by extract_pubkey.py.
+ */
+const ECDSA_CombTable_t ECDSA_public_key_comb = {
+    .public_key = {
+        0x3C, 0xDE, 0x3A, 0xD2, 0x7E, 0xC2, 0xFB, 0xB7,
+        0xFA, 0x3F, 0xE2, 0x09, 0xFB, 0xF3, 0xC7, 0x5F,
+        0xEC, 0xC1, 0xE6, 0x7E, 0x71, 0xCD, 0x19, 0xD2,
+        0x80, 0xE7, 0xAB, 0xBC, 0x6B, 0x8A, 0xB9, 0x7E,
+        0x89, 0xB5, 0x35, 0x9B, 0xE8, 0x7B, 0x99, 0x7B,
+        0x84, 0xDB, 0xEC, 0xD8, 0x7B, 0x28, 0x00, 0x5D,
+        0xA8, 0xE6, 0x29, 0x5C, 0xDE, 0x3C, 0x7C, 0x34,
+        0xC2, 0xE2, 0xBE, 0xD9, 0x17, 0x38, 0xFF, 0xA5
+    },
+    .points = {
+        {
+            0x6B8AB97E, 0x80E7ABBC, 0x71CD19D2, 0xECC1E67E, 0xFBF3C75F, 0xFA3FE209, 0x7EC2FBB7, 0x3CDE3AD2,
+            0x1738FFA5, 0xC2E2BED9, 0xDE3C7C34, 0xA8E6295C, 0x7B28005D, 0x84DBECD8, 0xE87B997B, 0x89B5359B
+        },
+        {
+            0xCE21F036, 0xAC7447B2, 0x27767A9B, 0x412BAF75, 0x39FD9019, 0xAF82E292, 0xC34BC01A, 0x5D5E93EC,
+            0x94CD7A87, 0x94BD692E, 0xB2BD2257, 0x1021002D, 0x369FFEC0, 0x738F1E3D, 0xB0CCEE43, 0x307F30D3
+        },
+        {
+            0x9A1C2920, 0x7A9C550E, 0x71BC834C, 0x53466AA3, 0xAE7944CD, 0xFA8A1FC7, 0x0E9592FE, 0x85B0B003,
+            0x90929D17, 0x077ADE6F, 0x3F444918, 0xF47A18FC, 0xB4424EF8, 0x1D8C51B3, 0xE7A61CE6, 0xE906D7E1
+        },
+        {
+            0x19FA4B27, 0x73664C55, 0xF5626627, 0x48E427D9, 0x72DA259B, 0x2ACE1526, 0x3C8814E7, 0x384A5B1B,
+            0x1A9F1DEF, 0x0455DF41, 0xFE1C49EB, 0x51942838, 0xEC281C7C, 0xF3CE33B2, 0xCEEAF83C, 0xAF55E512
+        },
+        {
+            0xFD2B6FA1, 0xF23A447F, 0x411B114D, 0x84DAAEF4, 0x5C566F05, 0xD6DB454E, 0x533FCDCC, 0xF5D38CC1,
+            0x77969A51, 0xEDE7A913, 0x4D1DDA20, 0xB9396A88, 0xD1BC6133, 0x10609503, 0x7A456858, 0xEAA4C361
+        },
+        {
+            0xCF6E878D, 0x907CD226, 0xC58E0F9A, 0x39A33CEC, 0x26688B48, 0x076D2151, 0xC64678A8, 0x1444B134,
+            0x43B2A2EE, 0x4F5580F3, 0xF53920AD, 0x2C434891, 0x38D64D81, 0x789BE267, 0x53A013BA, 0x65BD2350
+        },
+        {
+            0x7445E60A, 0xA0EBE56C, 0x295EB0B1, 0x4D3545A9, 0x9B4DCEC3, 0x91740738, 0x8B2C8A2E, 0x83860220,
+            0x13CF4394, 0x26865FC3, 0x03073719, 0x1BB0EA28, 0xE33C35A0, 0x81378119, 0x87D8EA9B, 0xB5EB9271
+        },
+        {
+            0x49A1B54F, 0x4D85C96E, 0x52448CEB, 0xAAC12512, 0x3F5B1C64, 0x1A1FE47B, 0x5F414074, 0x2DB2F929,
+            0xCC43BCAD, 0x883463D8, 0xE83C67B4, 0xC6E6496C, 0x5B6F553F, 0xA24AB355, 0x1272F9EF, 0x40F5D6F9
+        },
+        {
+            0x342DB1D6, 0xE14B8E00, 0xC44C9639, 0x5482CA40, 0xBE626A97, 0x6416020A, 0x13744F2F, 0xA5F62D6A,
+            0xD387C175, 0x22BA9BBF, 0x189A1888, 0xDC4F2F71, 0x5D5929EA, 0xC1E75B79, 0x6DF54383, 0x6FCBDA39
+        },
+        {
+            0x69111ED6, 0x9F8F19D0, 0x6304E29B, 0x8961D838, 0xCE78F5B2, 0x07A22BC1, 0x04A7355B, 0xAD15CFFE,
+            0x4154D4E5, 0xC9D7C8C2, 0xBDFDB0FB, 0x2BCEB5FE, 0x3B91AF68, 0xF17BB9E0, 0xF94D48B4, 0xF9A38818
+        },
+        {
+            0x97292E69, 0xE7C00DE7, 0x0AC5A6A3, 0x82A348F4, 0x96DE52A3, 0x972A350D, 0xB06E6922, 0x8AC63D2C,
+            0x69E90747, 0xB910A79F, 0x06719441, 0x74B54591, 0x8DC817F5, 0xE5B5847F, 0xEB352FD0, 0x2676F7A8
+        },
+        {
+            0x6E371416, 0x601BBA32, 0x8F98F362, 0x6BCC52F6, 0xCF963086, 0x3B917488, 0xCB920F14, 0x96DB6DA9,
+            0xE00AEC7B, 0x6E6C2ED0, 0xA23C86FF, 0x47D47DC0, 0x901D24F6, 0x2E5614BD, 0x7CDEDEBF, 0x5873D844
+        },
+        {
+            0xDC3A2F1C, 0xC735D2EE, 0x16FA116A, 0x91D6269E, 0xF2ACB978, 0x90E055DD, 0x3EB46CD0, 0x35DE5477,
+            0xB7DA6603, 0x0B17FFBA, 0x316A670A, 0x5611A582, 0xDA75988E, 0x12391DA5, 0x2AD87F25, 0xBCCDEA55
+        },
+        {
+            0xB6B9D054, 0x8212EF72, 0x088E9C68, 0xBDBC5C4F, 0x9FF33771, 0x45BA6D67, 0xCAF3084D, 0x6FA753BA,
+            0x91935087, 0x084ED5E6, 0x4DF3445E, 0x3B7DE653, 0x43042EC7, 0x03CFE3D7, 0x5567701C, 0xD7AEA71B
+        },
+        {
+            0x40EE60CC, 0x4ABC4B9B, 0x9CE1A477, 0x69BB3F27, 0x3354496C, 0xA7F64D10, 0x75C6227B, 0x47937456,
+            0xAB69E918, 0x8441F735, 0x52BEC8DA, 0xD2CFCD02, 0x29304116, 0xC92BD3AC, 0x0C387A71, 0x26E83826
+        },
+        {
+            0xD00E5817, 0x7E7D79BB, 0x390834F0, 0xB27FE72C, 0xEFD447DC, 0x08819993, 0x750E9D18, 0x19B1DF63,
+            0x61168D1F, 0x4396ECD4, 0xD10E8DC7, 0x33336FF0, 0x86DE9A32, 0xFC6C7045, 0xBE21645C, 0x5D0B6A45
+        },
+        {
+            0xA79D95A6, 0xE405C3F6, 0x671E92E6, 0x712B4EA9, 0xD68ED864, 0xB3FD430D, 0xBAFB3406, 0x3BC77515,
+            0x8EAE4533, 0x41A31ECD, 0xB7A98CFC, 0xD4714F99, 0xD48C3E3D, 0x475AE03B, 0x3288ADFD, 0x759D00C4
+        },
+        {
+            0x56C57858, 0x9D7B82DE, 0x8944A911, 0xEA39288B, 0x7F3DD281, 0x25A8F721, 0x2D7F6986, 0xA957325C,
+            0xBBC47741, 0x161CAA84, 0x97068186, 0x62BC5A55, 0xCEF061C4, 0xF58690C3, 0x0A75DE9F, 0xF1EE29AC
+        },
+        {
+            0x1C42294E, 0x48099869, 0x8620AC9C, 0x790AB341, 0xB75B75E5, 0x54FB8758, 0x15E78123, 0x539464F9,
+            0xC68A8F19, 0x106826A2, 0x8487D71F, 0x63F0AA1E, 0x82D7E105, 0x08AABC71, 0x7902548B, 0xE152F3E9
+        },
+        {
+            0x88933B65, 0x8876EF50, 0xEDCF811D, 0xECB9EC20, 0x0AF453F9, 0x241422BB, 0x6C9F551D, 0x63C48588,
+            0x153C87E7, 0xE2DB8F9B, 0x9A3A7889, 0x7A0C1240, 0x957383BB, 0x8FE6DF9F, 0x05B2C1FA, 0x7EC9A967
+        },
+        {
+            0xC98020C1, 0xB742C5FA, 0x30210820, 0xFB5BCB30, 0xFA940572, 0xDE3A26B8, 0x030ECBFD, 0x8EA09F17,
+            0xC824A687, 0x549B6308, 0x7367CB27, 0xECB4CB15, 0x920E4FF2, 0xD7302276, 0xECC7CE74, 0xA4C5B7CF
+        },
+        {
+            0xAB36005B, 0x048B1540, 0x2283105C, 0x70D33532, 0xCF777A30, 0xAE32FAAC, 0x80BA7C76, 0xDC7E8396,
+            0x5549E141, 0x553F2A12, 0xFDFAD750, 0x094CAD56, 0xC6636B13, 0x63AD875F, 0x6A14B20B, 0xF62FED2D
+        },
+        {
+            0x71B9489A, 0x0702DDEF, 0x5EA2BFA9, 0x8432F06A, 0xCDF8B6D3, 0x7AF31F2E, 0x7B33678D, 0x43FC717C,
+            0x32505FE4, 0x1D2CA321, 0x32E43DB1, 0xCA67D9EB, 0x9D79F683, 0x2B19BB43, 0xD4A157BF, 0x9EE60FB7
+        },
+        {
+            0x37AEA09C, 0x5AABEB46, 0x50B3CE43, 0x41C00C6F, 0x874692CB, 0x423F4697, 0x066098FD, 0xA98AA6FF,
+            0xECC266C3, 0xB2A339E0, 0x2C52BA7C, 0x4FA25F9E, 0x3990E886, 0xA37F54CC, 0xA97B1AED, 0x87C5BA80
+        },
+        {
+            0xCA465EE6, 0xF3C640AF, 0x78F2741A, 0x0812D2B4, 0x661BD9FD, 0x217D29FC, 0xBA81E330, 0xD59F11C1,
+            0x3BBF8C52, 0xD08E67C9, 0xAF4C389D, 0x76EA7F4C, 0x5B2E01F5, 0x0D384611, 0x26E13456, 0x88C2EBDF
+        },
+        {
+            0xBD442DAE, 0xD73FD4B9, 0xF274AF7A, 0x070E9ED4, 0x31D3CB98, 0x0E3B12F9, 0x7AAC82E3, 0xFFFD313C,
+            0x612AB929, 0xA5063DE0, 0x7840D360, 0xF4303CA9, 0xD50E6C75, 0xA6A15879, 0x53862034, 0x855CB900
+        },
+        {
+            0x2392FF74, 0xBBEE6C0B, 0x88D03C92, 0xA51219CE, 0x028F6409, 0xF0C8E3CD, 0xDE4B643A, 0x147001EB,
+            0xFE3F2A01, 0x768E9A57, 0xACB2ED6F, 0xE4E59088, 0x38B01D59, 0xCDB25E80, 0x40B81750, 0xCFC2C51F
+        },
+        {
+            0xCC8F60F9, 0x3940E12D, 0x5DE1E9F4, 0x84429DBB, 0x7DE5CAAE, 0x023C4F7C, 0x1C6E6B53, 0xCDB312F6,
+            0x93E76F57, 0x369C69D2, 0xD7CEE1FF, 0x19796C49, 0x6FC5EB27, 0x28C3060E, 0x5DB5CB9F, 0xAA1E9A84
+        },
+        {
+            0xA957FC45, 0x0FEA0AD9, 0xD0A2A39E, 0x3FE19794, 0x60EC7C52, 0xD43F2D8B, 0xB2919E78, 0xE4756AC5,
+            0x05090BFC, 0x64A4CEAA, 0x8A27E774, 0x281AAEA4, 0x72DEDCE4, 0xF7DB7863, 0x6C8D6994, 0x1FE2CA5B
+        },
+        {
+            0xC8DA5FD2, 0x3E081833, 0xE53A2BBF, 0x7B97B738, 0xEF2605C7, 0x865D038A, 0x266B15A8, 0xED13F417,
+            0x48FB8042, 0x98456027, 0x5D0B4D1C, 0xC0B2A5D1, 0x8D84B174, 0x9ABCB9E8, 0xE6AD77D3, 0x2EFF3C8C
+        },
+        {
+            0xF0722E14, 0xC656730D, 0xB6BC7003, 0x94E02F6D, 0xB5D8B551, 0x960307D6, 0x19F0EF82, 0xBF9D3AFC,
+            0x07462F55, 0x1D168420, 0xE52C008B, 0x588A2067, 0x1AF7CFAC, 0xF4ADF464, 0xD62CBF4B, 0xE216A321
+        },
+    }
+};
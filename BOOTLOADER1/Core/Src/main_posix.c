@@ -0,0 +1,19 @@
+/*
+ * main_posix.c
+ *
+ * Entry point of the host build. Runs the unchanged bootloader on the
+ * flash image of system_driver_posix.c; a SystemReset() comes back here
+ * like a reset re-enters main() on the MCU.
+ */
+
+#include "bootloader_core.h"
+#include "system_driver_posix.h"
+
+int main(void) {
+    setjmp(posix_reset_point);
+
+    Bootloader_Run(Sys_GetInterface());
+
+    /* Bootloader_Run returns only when JumpToApp() refused the image */
+    return POSIX_EXIT_HALT;
+}
@@ -0,0 +1,55 @@
+"""Benchmark (user-021): backup and rollback cost against the image size.
+
+Installs an update over an image of each size, then rolls back to it.
+Reports the S5 bytes the backup encrypts, the bytes each pass programs
+and the host time. The passes must track the image, not SLOT_SIZE: the
+backup reads exactly the image, and neither pass programs more than its
+three copies (stage, backup, install).
+"""
+
+import argparse
+
+from sim import S5, S6, SLOT_SIZE, EXIT_APP, STATE_ROLLBACK, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+SIZES = [8 * 1024, 32 * 1024, 64 * 1024, 128 * 1024, 200 * 1024]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True, help="bootloader_posix on the test keys")
+    args = parser.parse_args()
+    t = Checks()
+
+    print(f"{'image':>7} {'backup read':>12} {'update prog':>12} {'rollback prog':>14} "
+          f"{'update ms':>10} {'rollback ms':>12} {'flash ms':>9}")
+    with Sim(args.bootloader) as sim:
+        for size in SIZES:
+            old = make_app(size, seed=1)
+            new = make_app(size, seed=2)
+
+            sim.erase_all()
+            sim.write(S5, old)
+            sim.write(S6, sim.package(new))
+            sim.set_state(STATE_UPDATE_REQ, 1, size)
+            update = sim.run()
+            t.check(update.rc == EXIT_APP and sim.holds(S5, new), f"{size}: update")
+
+            sim.set_state(STATE_ROLLBACK, 1, size)
+            rollback = sim.run()
+            t.check(rollback.rc == EXIT_APP and sim.holds(S5, old), f"{size}: rollback")
+
+            print(f"{size:>7} {update.reads['S5']:>12} {update.programmed:>12} "
+                  f"{rollback.programmed:>14} {update.seconds * 1000:>10.1f} "
+                  f"{rollback.seconds * 1000:>12.1f} {update.flash_ms + rollback.flash_ms:>9}")
+
+            t.check(update.reads["S5"] == size, f"{size}: backup reads the image only")
+            for name, run in (("update", update), ("rollback", rollback)):
+                t.check(run.programmed <= 3 * size + 4096,
+                        f"{size}: {name} programs {run.programmed} bytes")
+            if size < SLOT_SIZE // 4:
+                t.check(update.programmed < SLOT_SIZE, f"{size}: update programs less than a slot")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,75 @@
+"""Benchmark (user-004): S6 bytes read by an install with and without BL_FUSED_VERIFY.
+
+Runs the same install, requested through the config as the application
+does, on a bootloader built with the fused verify (hash while decrypting
+into scratch) and on one built with a separate signature pass. Reports
+the S6 bytes each reads through the crypto ops: the fused build must
+save a whole pass over the package. An install requested with the button
+must read no more than one requested through the config (user-018).
+"""
+
+import argparse
+
+from sim import S5, S6, EXIT_APP, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+FORMATS = [
+    ("AES-CBC", []),
+    ("AES-CTR", ["--ctr"]),
+    ("ChaCha20", ["--chacha20"]),
+    ("LZ4 + CBC", ["--lz4"]),
+]
+
+
+def install(sim, bootloader, old, package, button=False):
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, package)
+    if not button:
+        sim.set_state(STATE_UPDATE_REQ)
+    return sim.run(button=button, bootloader=bootloader)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--fused", required=True, help="bootloader_posix with BL_FUSED_VERIFY=1")
+    parser.add_argument("--separate", required=True, help="bootloader_posix with BL_FUSED_VERIFY=0")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    new = make_app(75 * 1024, seed=2, compressible=True)
+
+    print(f"{'format':<10} {'package':>8} {'S6 read fused':>14} {'separate':>9} {'saved':>8} "
+          f"{'button':>8} {'host ms fused':>14} {'separate':>9}")
+    with Sim(args.fused) as sim:
+        for name, opts in FORMATS:
+            package = sim.package(new, *opts)
+            fused = install(sim, args.fused, old, package)
+            t.check(fused.rc == EXIT_APP and sim.holds(S5, new), f"{name}: fused install")
+            separate = install(sim, args.separate, old, package)
+            t.check(separate.rc == EXIT_APP and sim.holds(S5, new), f"{name}: separate install")
+
+            button = install(sim, args.fused, old, package, button=True)
+            t.check(button.rc == EXIT_APP and sim.holds(S5, new), f"{name}: button install")
+
+            saved = separate.reads["S6"] - fused.reads["S6"]
+            print(f"{name:<10} {len(package):>8} {fused.reads['S6']:>14} {separate.reads['S6']:>9} "
+                  f"{saved:>8} {button.reads['S6']:>8} {fused.seconds * 1000:>14.1f} "
+                  f"{separate.seconds * 1000:>9.1f}")
+
+            # The separate verify pass reads the whole package once more
+            t.check(saved >= len(package) - 128, f"{name}: saves a pass over S6")
+            # The button only locates the package; the fused pass is the one check
+            t.check(button.reads["S6"] == fused.reads["S6"], f"{name}: button reads S6 once")
+
+        # A bad signature found by that one check: rejected, old app kept
+        package = bytearray(sim.package(new))
+        package[100] ^= 1
+        bad = install(sim, args.fused, old, bytes(package), button=True)
+        t.check(bad.rc == EXIT_APP and sim.holds(S5, old) and sim.holds(S6, b"\xff" * 64),
+                "tampered package with the button: rejected and erased")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,70 @@
+"""Benchmark (user-006): LZ4 compression ratio and install time on real binaries.
+
+Packages each binary with and without --lz4, installs both on the
+simulator and reports package sizes, S6 bytes read and install time
+(simulated flash time and host time). The default corpus is the host
+executables of this build, as no Thumb-2 toolchain is needed for the
+tests; pass --bin with application images for numbers on real firmware.
+Images without a vector table for S5 get one patched in.
+"""
+
+import argparse
+import os
+import struct
+
+from sim import S5, S6, SLOT_SIZE, EXIT_APP, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+MAX_IMAGE = 200 * 1024   # Leaves room for the footer and a bad compression ratio
+
+
+def load_image(path):
+    with open(path, "rb") as f:
+        image = f.read(MAX_IMAGE)
+    image += b"\0" * (-len(image) % 4)
+    entry = struct.unpack_from("<I", image, 4)[0]
+    if not S5 < entry < S5 + len(image):
+        image = struct.pack("<II", 0x20050000, S5 + 0x199) + image[8:]
+    return image
+
+
+def install(sim, bootloader, old, package):
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, package)
+    sim.set_state(STATE_UPDATE_REQ)
+    return sim.run(bootloader=bootloader)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True, help="bootloader_posix")
+    parser.add_argument("--bin", nargs="+", required=True, help="binaries to package")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    print(f"{'binary':<20} {'image':>7} {'package':>8} {'LZ4':>8} {'ratio':>6} "
+          f"{'flash ms':>9} {'LZ4':>6} {'host ms':>8} {'LZ4':>6}")
+    with Sim(args.bootloader) as sim:
+        for path in args.bin:
+            name = os.path.basename(path)
+            image = load_image(path)
+            plain = sim.package(image)
+            packed = sim.package(image, "--lz4")
+            if len(packed) > SLOT_SIZE:
+                print(f"{name:<20} skipped: the LZ4 package does not fit a slot")
+                continue
+
+            raw = install(sim, args.bootloader, old, plain)
+            t.check(raw.rc == EXIT_APP and sim.holds(S5, image), f"{name}: installs")
+            lz4 = install(sim, args.bootloader, old, packed)
+            t.check(lz4.rc == EXIT_APP and sim.holds(S5, image), f"{name}: installs from LZ4")
+
+            print(f"{name:<20} {len(image):>7} {len(plain):>8} {len(packed):>8} "
+                  f"{len(packed) / len(plain):>6.2f} {raw.flash_ms:>9} {lz4.flash_ms:>6} "
+                  f"{raw.seconds * 1000:>8.1f} {lz4.seconds * 1000:>6.1f}")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,67 @@
+"""Benchmark (user-023): a 75 KB update staged in RAM against one staged in S7.
+
+Runs the same install with the default RAM staging window and with
+BL_SIM_RAM_STAGE_SIZE=0, which stages in S7 as a build without a window
+does. Reports erases, bytes programmed and modelled flash time: staging
+in RAM must save the S7 erase and its program pass, and leave S7 alone.
+A window too small for the image must fall back to S7.
+"""
+
+import argparse
+
+from sim import S5, S6, S7, SLOT_SIZE, EXIT_APP, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+FORMATS = [
+    ("AES-CBC", []),
+    ("ChaCha20", ["--chacha20"]),
+    ("AEAD", ["--aead"]),
+    ("LZ4 + CBC", ["--lz4"]),
+]
+
+
+def install(sim, old, package, **env):
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, package)
+    sim.set_state(STATE_UPDATE_REQ)
+    return sim.run(**env)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True, help="bootloader_posix on the test keys")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    new = make_app(75 * 1024, seed=2, compressible=True)
+
+    print(f"{'format':<10} {'erases RAM':>10} {'S7':>4} {'programmed RAM':>15} {'S7':>7} "
+          f"{'flash ms RAM':>13} {'S7':>6}")
+    with Sim(args.bootloader) as sim:
+        for name, opts in FORMATS:
+            package = sim.package(new, *opts)
+
+            ram = install(sim, old, package)
+            t.check(ram.rc == EXIT_APP and sim.holds(S5, new), f"{name}: RAM-staged install")
+            t.check(sim.holds(S7, b"\xff" * SLOT_SIZE), f"{name}: S7 untouched")
+
+            s7 = install(sim, old, package, BL_SIM_RAM_STAGE_SIZE=0)
+            t.check(s7.rc == EXIT_APP and sim.holds(S5, new), f"{name}: S7-staged install")
+
+            print(f"{name:<10} {ram.erases:>10} {s7.erases:>4} {ram.programmed:>15} "
+                  f"{s7.programmed:>7} {ram.flash_ms:>13} {s7.flash_ms:>6}")
+
+            t.check(ram.erases == s7.erases - 1, f"{name}: saves the S7 erase")
+            t.check(ram.programmed <= s7.programmed - len(new), f"{name}: saves a program pass")
+            t.check(ram.flash_ms < s7.flash_ms, f"{name}: less flash time")
+
+        # A window smaller than the image stages in S7
+        small = install(sim, old, sim.package(new), BL_SIM_RAM_STAGE_SIZE=64 * 1024)
+        t.check(small.rc == EXIT_APP and sim.holds(S5, new), "64 KB window: install")
+        t.check("-> S7" in small.out, "64 KB window: staged in S7")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,263 @@
+"""Helpers for the simulator tests: build packages, lay out flash, run bootloader_posix.
+
+A Sim owns a scratch directory with the test keys, a flash image and the
+package generator's output. run() starts the bootloader on the image and
+returns its exit code, console output and the [SIM] report.
+"""
+
+import hashlib
+import os
+import random
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+KEY_DIR = os.path.join(HERE, "keys")
+GENERATOR = os.path.join(HERE, "..", "..", "Key", "generate_update.py")
+
+# Must match mem_layout.h
+FLASH_BASE = 0x08000000
+FLASH_SIZE = 0x00100000
+CONFIG = 0x08010000
+CONFIG_ALT = 0x08018000
+S5 = 0x08040000
+S6 = 0x08080000
+S7 = 0x080C0000
+SLOT_SIZE = 0x00040000
+
+# Must match bootloader_config.h
+CONFIG_MAGIC = 0xDEADBEEF
+XIP_MAGIC = 0x58495021
+STATE_NORMAL = 4
+STATE_UPDATE_REQ = 5
+STATE_ROLLBACK = 6
+CONFIG_SLOT_SIZE = 0x8000
+RECORD_SIZE = 96
+
+# Must match system_driver_posix.h
+EXIT_APP = 0
+EXIT_HALT = 1
+EXIT_RESET_LOOP = 2
+EXIT_CUT = 3
+
+REPORT = re.compile(r"\[SIM\] (\d+) boot\(s\), (\d+) sector erases, (\d+) bytes programmed "
+                    r"in (\d+) calls, (\d+) ms flash busy")
+READS = re.compile(r"\[SIM\] Read by crypto ops: S5 (\d+), S6 (\d+), S7 (\d+) bytes")
+SLOT_ERASES = re.compile(r"\[SIM\] Sector erases: S5 (\d+), S6 (\d+), S7 (\d+)")
+
+
+def make_app(size, seed=1, slot=S5, compressible=False):
+    """A fake application of `size` bytes with a vector table for `slot`.
+
+    The body is random, or with compressible set, random 64-byte words
+    repeated the way code repeats instruction sequences.
+    """
+    rnd = random.Random(seed)
+    if compressible:
+        words = [rnd.randbytes(64) for _ in range(32)]
+        body = b"".join(rnd.choice(words)[:rnd.randrange(8, 65)] for _ in range(size // 8 + 64))
+    else:
+        body = rnd.randbytes(size)
+    entry = slot + (min(0x199, max(size - 1, 8)) | 1)
+    vectors = struct.pack("<II", 0x20050000, entry)
+    return (vectors + body)[:size] if size >= 8 else vectors[:size]
+
+
+class Result:
+    def __init__(self, rc, out, err, seconds):
+        self.rc = rc
+        self.out = out
+        self.err = err
+        self.seconds = seconds
+        m = REPORT.search(err)
+        self.boots, self.erases, self.programmed, self.calls, self.flash_ms = \
+            (int(v) for v in m.groups()) if m else (0, 0, 0, 0, 0)
+        m = READS.search(err)
+        self.reads = {"S5": 0, "S6": 0, "S7": 0}
+        if m:
+            self.reads = dict(zip(("S5", "S6", "S7"), (int(v) for v in m.groups())))
+        m = SLOT_ERASES.search(err)
+        self.slot_erases = {"S5": 0, "S6": 0, "S7": 0}
+        if m:
+            self.slot_erases = dict(zip(("S5", "S6", "S7"), (int(v) for v in m.groups())))
+
+    def __repr__(self):
+        return (f"rc={self.rc} boots={self.boots} erases={self.erases} "
+                f"programmed={self.programmed} calls={self.calls} flash_ms={self.flash_ms}")
+
+
+class Sim:
+    def __init__(self, bootloader):
+        self.bootloader = os.path.abspath(bootloader)
+        self.dir = tempfile.mkdtemp(prefix="bl_sim_")
+        for name in ("private.pem", "secret.key"):
+            shutil.copy(os.path.join(KEY_DIR, name), self.dir)
+        self.image = os.path.join(self.dir, "flash.bin")
+        self.erase_all()
+
+    def close(self):
+        shutil.rmtree(self.dir, ignore_errors=True)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    # --- Packages ---
+
+    def package(self, image, *args, version=None):
+        """Runs generate_update.py on image with args; returns the package bytes."""
+        fw = os.path.join(self.dir, "fw.bin")
+        with open(fw, "wb") as f:
+            f.write(image)
+        cmd = [sys.executable, GENERATOR, fw, *args]
+        if version is not None:
+            cmd += ["--version", hex(version)]
+        out = subprocess.run(cmd, cwd=self.dir, capture_output=True, text=True)
+        if "[SUCCESS]" not in out.stdout:
+            raise RuntimeError(f"generate_update.py {' '.join(args)} failed:\n{out.stdout}{out.stderr}")
+        name = re.search(r"created: (\S+)", out.stdout).group(1)
+        with open(os.path.join(self.dir, name), "rb") as f:
+            return f.read()
+
+    def package_bad_lz4(self, image, cipher_mode="cbc", chunked=False):
+        """A signed LZ4 package whose first record length is impossible, as a
+        faulty packaging tool would make; the options are generate_update()'s."""
+        fw = os.path.join(self.dir, "fw.bin")
+        with open(fw, "wb") as f:
+            f.write(image)
+        script = ("import struct, sys; sys.path.insert(0, sys.argv[1]); import generate_update as g; "
+                  "good = g.lz4_compress; "
+                  "g.lz4_compress = lambda d: struct.pack('<I', 0x7FFFFFFF) + good(d)[4:]; "
+                  "g.generate_update(sys.argv[2], compress=True, cipher_mode=sys.argv[3], "
+                  "chunked=sys.argv[4] == '1')")
+        cmd = [sys.executable, "-c", script, os.path.dirname(GENERATOR), fw, cipher_mode,
+               "1" if chunked else "0"]
+        out = subprocess.run(cmd, cwd=self.dir, capture_output=True, text=True)
+        if "[SUCCESS]" not in out.stdout:
+            raise RuntimeError(f"bad LZ4 package ({cipher_mode}) failed:\n{out.stdout}{out.stderr}")
+        name = re.search(r"created: (\S+)", out.stdout).group(1)
+        with open(os.path.join(self.dir, name), "rb") as f:
+            return f.read()
+
+    def package_legacy(self, image, version=0x0100):
+        """A package as generate_update.py made it before fw_header_t existed:
+        [ IV ][ AES-128-CBC, PKCS#7 ][ fw_footer_t ], signed over IV and data."""
+        from Crypto.Cipher import AES
+        from Crypto.Util.Padding import pad
+        from ecdsa import SigningKey
+        with open(os.path.join(self.dir, "private.pem"), "rb") as f:
+            sk = SigningKey.from_pem(f.read())
+        with open(os.path.join(self.dir, "secret.key"), "rb") as f:
+            aes_key = f.read()
+        iv = os.urandom(16)
+        payload = iv + AES.new(aes_key, AES.MODE_CBC, iv).encrypt(pad(image, 16))
+        signature = sk.sign_digest(hashlib.sha256(payload).digest())
+        return payload + struct.pack("<II", version, len(payload)) + signature + \
+            struct.pack("<I", 0x454E4421)
+
+    def resign(self, package):
+        """Signs a package again after a test edited its payload (layouts signed in full)."""
+        from ecdsa import SigningKey
+        with open(os.path.join(self.dir, "private.pem"), "rb") as f:
+            sk = SigningKey.from_pem(f.read())
+        size = struct.unpack_from("<I", package, len(package) - 72)[0]
+        signature = sk.sign_digest(hashlib.sha256(package[:size]).digest())
+        return package[:-68] + signature + package[-4:]
+
+    # --- Flash image ---
+
+    def erase_all(self):
+        with open(self.image, "wb") as f:
+            f.write(b"\xff" * FLASH_SIZE)
+
+    def write(self, addr, data):
+        with open(self.image, "r+b") as f:
+            f.seek(addr - FLASH_BASE)
+            f.write(data)
+
+    def erase(self, addr, size):
+        self.write(addr, b"\xff" * size)
+
+    def read(self, addr, size):
+        with open(self.image, "rb") as f:
+            f.seek(addr - FLASH_BASE)
+            return f.read(size)
+
+    def holds(self, addr, data):
+        return self.read(addr, len(data)) == data
+
+    def config_log(self, base):
+        """(records used, newest good seq) of the config sector at base."""
+        log = self.read(base, CONFIG_SLOT_SIZE)
+        used = 0
+        seq = 0
+        while used < CONFIG_SLOT_SIZE // RECORD_SIZE:
+            rec = log[used * RECORD_SIZE:(used + 1) * RECORD_SIZE]
+            if rec[:4] == b"\xff" * 4:
+                break
+            if zlib.crc32(rec[:-4]) == struct.unpack_from("<I", rec, RECORD_SIZE - 4)[0]:
+                seq = max(seq, struct.unpack_from("<I", rec)[0])
+            used += 1
+        return used, seq
+
+    def set_state(self, status, version=0, size=0, slot=None):
+        """Appends a config record with status, as the application does to request an update.
+
+        Like BL_WriteConfig(): the record goes to the sector holding the newest
+        one, or to the other sector, erased, when that one is full. slot records
+        the slot a BL_XIP_AB build runs from; by default none is recorded.
+        """
+        (used_a, seq_a), (used_b, seq_b) = self.config_log(CONFIG), self.config_log(CONFIG_ALT)
+        base, used = (CONFIG_ALT, used_b) if seq_b > seq_a else (CONFIG, used_a)
+        if used == CONFIG_SLOT_SIZE // RECORD_SIZE:
+            base, used = CONFIG_ALT if base == CONFIG else CONFIG, 0
+            self.erase(base, CONFIG_SLOT_SIZE)
+        body = struct.pack("<I4I", max(seq_a, seq_b) + 1, CONFIG_MAGIC, status, version, size)
+        xip = struct.pack("<II", XIP_MAGIC, slot) if slot is not None else b""
+        body += xip + b"\0" * (56 - len(xip)) + b"\xff" * 16
+        self.write(base + used * RECORD_SIZE, body + struct.pack("<I", zlib.crc32(body)))
+
+    def save(self):
+        with open(self.image, "rb") as f:
+            return f.read()
+
+    def restore(self, snapshot):
+        with open(self.image, "wb") as f:
+            f.write(snapshot)
+
+    # --- Runs ---
+
+    def run(self, button=False, bootloader=None, **env):
+        """Runs the bootloader until it jumps to the app, halts, loops or is cut off."""
+        run_env = dict(os.environ, BL_FLASH_IMAGE=self.image, BL_BUTTON="1" if button else "0")
+        run_env.update({k: str(v) for k, v in env.items()})
+        start = time.perf_counter()
+        p = subprocess.run([bootloader or self.bootloader], env=run_env, capture_output=True,
+                           text=True, errors="replace")
+        return Result(p.returncode, p.stdout, p.stderr, time.perf_counter() - start)
+
+
+class Checks:
+    """Counts failed checks like test_util.h; exit() returns the ctest status."""
+
+    def __init__(self):
+        self.failures = 0
+
+    def check(self, cond, what):
+        if not cond:
+            print(f"CHECK failed: {what}")
+            self.failures += 1
+        return cond
+
+    def exit(self):
+        if self.failures:
+            print(f"{self.failures} check(s) failed")
+        sys.exit(1 if self.failures else 0)
@@ -0,0 +1,131 @@
+"""Test (user-019): the signed AEAD manifest binds the ciphertext.
+
+Every device holds the AES key, and so the ChaCha20 key that makes the
+Poly1305 one-time keys. With it, anyone can find other ciphertext with
+the same tag as a genuine package. Builds such a forgery: a chosen image
+encrypted under the package's nonce, with one block solved so that the
+Poly1305 tag stays the same, under the genuine header, tag and signature.
+The forgery is checked to pass ChaCha20-Poly1305 itself. The bootloader
+must then reject it by the signed ciphertext digest, on the fused and the
+separate verify builds. A damaged digest must fail the signature.
+"""
+
+import argparse
+import hashlib
+import os
+import random
+import struct
+
+from Crypto.Cipher import ChaCha20, ChaCha20_Poly1305
+
+from sim import S5, S6, S7, EXIT_APP, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+HEADER = 16
+IV = 16
+TAG = 16
+DIGEST = 32
+FOOTER = 76
+P = (1 << 130) - 5
+
+
+def poly_blocks(aad, ct):
+    """Poly1305 input blocks (with the 2^128 bit) of RFC 8439 AEAD; aad is 16 bytes."""
+    data = aad + ct + b"\0" * (-len(ct) % 16) + struct.pack("<QQ", len(aad), len(ct))
+    return [int.from_bytes(data[i:i + 16], "little") + (1 << 128) for i in range(0, len(data), 16)]
+
+
+def forge(package, aes_key, image, rnd):
+    """Ciphertext for image under the package's nonce, with the package's Poly1305 tag."""
+    header = package[:HEADER]
+    nonce = package[HEADER:HEADER + 12]
+    ct_len = len(package) - HEADER - IV - TAG - DIGEST - FOOTER
+    key = hashlib.sha256(b"BL ChaCha20 key" + aes_key).digest()
+
+    stream = ChaCha20.new(key=key, nonce=nonce)
+    poly_key = stream.encrypt(b"\0" * 64)[:32]
+    r = int.from_bytes(poly_key[:16], "little") & 0x0FFFFFFC0FFFFFFC0FFFFFFC0FFFFFFF
+    image = image + b"\0" * (ct_len - len(image))
+    ct = bytearray(stream.encrypt(image))
+
+    target = 0
+    for m in poly_blocks(header, package[HEADER + IV:HEADER + IV + ct_len]):
+        target = (target + m) * r % P
+
+    # Solve one block near the end; retry with another free block if it does not fit 16 bytes
+    k = ct_len // 16 - 2
+    while True:
+        blocks = poly_blocks(header, bytes(ct))
+        n = len(blocks)
+        rest = 0
+        for i, m in enumerate(blocks):
+            if i != 1 + k:
+                rest = (rest + m * pow(r, n - i, P)) % P
+        # Block 1 + k (after the header) ends up multiplied by r^(n - 1 - k)
+        x = (target - rest) * pow(pow(r, n - 1 - k, P), -1, P) % P
+        if (1 << 128) <= x < (1 << 129):
+            ct[16 * k:16 * k + 16] = (x - (1 << 128)).to_bytes(16, "little")
+            return bytes(ct), key
+        j = rnd.randrange(0, k)
+        ct[16 * j] ^= 1
+
+
+def install(sim, bootloader, old, package):
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, package)
+    sim.set_state(STATE_UPDATE_REQ)
+    return sim.run(bootloader=bootloader)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--fused", required=True, help="bootloader_posix with BL_FUSED_VERIFY=1")
+    parser.add_argument("--separate", required=True, help="bootloader_posix with BL_FUSED_VERIFY=0")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    new = make_app(40 * 1024, seed=2)
+    evil = make_app(40 * 1024, seed=3)
+
+    with Sim(args.fused) as sim:
+        with open(os.path.join(sim.dir, "secret.key"), "rb") as f:
+            aes_key = f.read()
+        package = sim.package(new, "--aead")
+        ct_len = len(package) - HEADER - IV - TAG - DIGEST - FOOTER
+        tail = package[HEADER + IV + ct_len:]
+        t.check(tail[TAG:TAG + DIGEST] == hashlib.sha256(package[HEADER + IV:HEADER + IV + ct_len]).digest(),
+                "package carries the SHA-256 of its ciphertext")
+
+        ct, key = forge(package, aes_key, evil, random.Random(7))
+        forged = package[:HEADER + IV] + ct + tail
+        cipher = ChaCha20_Poly1305.new(key=key, nonce=package[HEADER:HEADER + 12])
+        cipher.update(package[:HEADER])
+        try:
+            plain = cipher.decrypt_and_verify(ct, tail[:TAG])
+            t.check(plain[:1024] == evil[:1024], "forgery decrypts to the chosen image")
+        except ValueError:
+            t.check(False, "forgery keeps the Poly1305 tag")
+
+        bad_digest = bytearray(package)
+        bad_digest[HEADER + IV + ct_len + TAG + 5] ^= 1
+
+        for build, bootloader in (("fused", args.fused), ("separate", args.separate)):
+            result = install(sim, bootloader, old, package)
+            t.check(result.rc == EXIT_APP and sim.holds(S5, new), f"{build}: genuine package installs")
+
+            result = install(sim, bootloader, old, forged)
+            t.check("Ciphertext Digest Mismatch" in result.out,
+                    f"{build}: forgery rejected by the signed digest")
+            t.check(result.rc == EXIT_APP and sim.holds(S5, old), f"{build}: forgery, S5 unchanged")
+            t.check(sim.read(S6, 0x1000) == b"\xff" * 0x1000, f"{build}: forgery, S6 erased")
+            t.check(sim.read(S7, 0x1000) == b"\xff" * 0x1000, f"{build}: forgery, stage wiped")
+
+            result = install(sim, bootloader, old, bytes(bad_digest))
+            t.check("ECDSA Signature Mismatch" in result.out, f"{build}: damaged digest fails the signature")
+            t.check(result.rc == EXIT_APP and sim.holds(S5, old), f"{build}: damaged digest, S5 unchanged")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,165 @@
+/*
+ * test_aes.c
+ *
+ * Known-answer tests of the SW_AES_* ops: FIPS-197 appendices B and C.1,
+ * and the SP 800-38A AES-128 ECB, CBC and CTR vectors. Built once per
+ * BL_AES_TTABLE setting; prints the throughput of that backend and, in
+ * the T-table build, checks that the tables beat TinyCrypt.
+ */
+
+#include <string.h>
+
+#include "test_util.h"
+#include "bootloader_config.h"
+#include "crypto_driver_sw.h"
+#include "aes_ttable.h"
+#include "aes.h"
+
+#define BENCH_SIZE  (64U * 1024U)
+#define BENCH_RUNS  16U
+
+/* SP 800-38A F.1-F.5: one key, four plaintext blocks */
+static const char sp_key[]   = "2b7e151628aed2a6abf7158809cf4f3c";
+static const char sp_plain[] = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                               "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+
+static void Test_Fips197(void) {
+    static const char *const vectors[][3] = {
+        /* Appendix B */
+        { "2b7e151628aed2a6abf7158809cf4f3c", "3243f6a8885a308d313198a2e0370734",
+          "3925841d02dc09fbdc118597196a0b32" },
+        /* Appendix C.1 */
+        { "000102030405060708090a0b0c0d0e0f", "00112233445566778899aabbccddeeff",
+          "69c4e0d86a7b0430d8cdb78070b4c55a" },
+    };
+
+    for (unsigned int v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        uint8_t key[16], plain[16], cipher[16], out[16];
+        BL_AesCtx_t ctx;
+
+        Test_Hex(key, vectors[v][0]);
+        Test_Hex(plain, vectors[v][1]);
+        Test_Hex(cipher, vectors[v][2]);
+        CHECK(SW_AES_Init(&ctx, key) == 0);
+
+        CHECK(SW_AES_ECB_Encrypt(&ctx, plain, out, 16) == 0);
+        CHECK(memcmp(out, cipher, 16) == 0);
+        CHECK(SW_AES_ECB_Decrypt(&ctx, cipher, out, 16) == 0);
+        CHECK(memcmp(out, plain, 16) == 0);
+
+        CHECK(SW_AES_EncryptBlock(key, plain, out) == 0);
+        CHECK(memcmp(out, cipher, 16) == 0);
+        CHECK(SW_AES_DecryptBlock(key, cipher, out) == 0);
+        CHECK(memcmp(out, plain, 16) == 0);
+    }
+}
+
+static void Test_Ecb(void) {
+    uint8_t key[16], plain[64], cipher[64], out[64];
+    BL_AesCtx_t ctx;
+
+    Test_Hex(key, sp_key);
+    Test_Hex(plain, sp_plain);
+    Test_Hex(cipher, "3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+                     "43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4");
+    CHECK(SW_AES_Init(&ctx, key) == 0);
+
+    CHECK(SW_AES_ECB_Encrypt(&ctx, plain, out, 64) == 0);
+    CHECK(memcmp(out, cipher, 64) == 0);
+    CHECK(SW_AES_ECB_Decrypt(&ctx, cipher, out, 64) == 0);
+    CHECK(memcmp(out, plain, 64) == 0);
+    CHECK(SW_AES_ECB_Encrypt(&ctx, plain, out, 8) != 0);
+}
+
+static void Test_Cbc(void) {
+    uint8_t key[16], iv[16], plain[64], cipher[64], out[64];
+    BL_AesCtx_t ctx;
+
+    Test_Hex(key, sp_key);
+    Test_Hex(iv, "000102030405060708090a0b0c0d0e0f");
+    Test_Hex(plain, sp_plain);
+    Test_Hex(cipher, "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+                     "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7");
+    CHECK(SW_AES_Init(&ctx, key) == 0);
+
+    /* Whole, then in calls chained on the previous ciphertext block */
+    CHECK(SW_AES_CBC_Decrypt(&ctx, iv, cipher, out, 64) == 0);
+    CHECK(memcmp(out, plain, 64) == 0);
+
+    memset(out, 0, sizeof(out));
+    CHECK(SW_AES_CBC_Decrypt(&ctx, iv, cipher, out, 16) == 0);
+    CHECK(SW_AES_CBC_Decrypt(&ctx, cipher, cipher + 16, out + 16, 32) == 0);
+    CHECK(SW_AES_CBC_Decrypt(&ctx, cipher + 32, cipher + 48, out + 48, 16) == 0);
+    CHECK(memcmp(out, plain, 64) == 0);
+
+    CHECK(SW_AES_CBC_Decrypt(&ctx, iv, cipher, out, 0) != 0);
+    CHECK(SW_AES_CBC_Decrypt(&ctx, iv, cipher, out, 24) != 0);
+}
+
+static void Test_Ctr(void) {
+    uint8_t key[16], ctr[16], plain[64], cipher[64], out[64];
+    BL_AesCtx_t ctx;
+
+    Test_Hex(key, sp_key);
+    Test_Hex(ctr, "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    Test_Hex(plain, sp_plain);
+    Test_Hex(cipher, "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                     "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+    CHECK(SW_AES_Init(&ctx, key) == 0);
+
+    CHECK(SW_AES_CTR_Xor(&ctx, ctr, plain, out, 64) == 0);
+    CHECK(memcmp(out, cipher, 64) == 0);
+    CHECK(SW_AES_CTR_Xor(&ctx, ctr, cipher, out, 61) == 0);
+    CHECK(memcmp(out, plain, 61) == 0);
+}
+
+static double Mb_Per_S(uint64_t ns) {
+    return (double)BENCH_SIZE * BENCH_RUNS / 1e6 / ((double)ns / 1e9);
+}
+
+static void Bench(void) {
+    static uint8_t in[BENCH_SIZE], out[BENCH_SIZE];
+    uint8_t key[16];
+    uint32_t seed = 5;
+    BL_AesCtx_t ctx;
+
+    Test_Fill(&seed, key, sizeof(key));
+    Test_Fill(&seed, in, sizeof(in));
+    SW_AES_Init(&ctx, key);
+
+    uint64_t t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        SW_AES_CBC_Decrypt(&ctx, key, in, out, BENCH_SIZE);
+    uint64_t cbc = Test_Now_Ns() - t;
+
+    t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        SW_AES_ECB_Encrypt(&ctx, in, out, BENCH_SIZE);
+    uint64_t ecb = Test_Now_Ns() - t;
+
+    printf("%s: CBC decrypt %.0f MB/s, ECB encrypt %.0f MB/s\n",
+           BL_AES_TTABLE ? "T-table" : "TinyCrypt", Mb_Per_S(cbc), Mb_Per_S(ecb));
+
+#if BL_AES_TTABLE
+    /* The same blocks through TinyCrypt, which the option replaces */
+    struct tc_aes_key_sched_struct sched;
+    tc_aes128_set_encrypt_key(&sched, key);
+    t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        for (uint32_t i = 0; i < BENCH_SIZE; i += 16)
+            tc_aes_encrypt(out + i, in + i, &sched);
+    uint64_t tc = Test_Now_Ns() - t;
+
+    printf("TinyCrypt: encrypt %.0f MB/s\n", Mb_Per_S(tc));
+    CHECK(ecb < tc);
+#endif
+}
+
+int main(void) {
+    Test_Fips197();
+    Test_Ecb();
+    Test_Cbc();
+    Test_Ctr();
+    Bench();
+    return TEST_EXIT();
+}
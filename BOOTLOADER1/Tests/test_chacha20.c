@@ -0,0 +1,193 @@
+/*
+ * test_chacha20.c
+ *
+ * RFC 8439 vectors for ChaCha20 (the 2.3.2 block, the 2.4.2 encryption
+ * and A.1 #1), Poly1305 (2.5.2) and the AEAD construction the
+ * FW_FLAG_AEAD install runs (2.8.2), random access by block counter,
+ * and the throughput of ChaCha20 against the AES-ECB backup path
+ * (BL_BACKUP_CHACHA20) with the build's AES backend and with TinyCrypt.
+ */
+
+#include <string.h>
+
+#include "test_util.h"
+#include "bootloader_config.h"
+#include "crypto_driver_sw.h"
+#include "chacha20.h"
+#include "aes.h"
+
+#define BENCH_SIZE  (64U * 1024U)
+#define BENCH_RUNS  16U
+
+static void Test_Rfc8439(void) {
+    static const char sunscreen[] =
+        "Ladies and Gentlemen of the class of '99: If I could offer you only one "
+        "tip for the future, sunscreen would be it.";
+    uint8_t key[32], nonce[12], expected[114], out[114];
+
+    for (int i = 0; i < 32; i++)
+        key[i] = (uint8_t)i;
+
+    /* 2.3.2: block 1 is the keystream XORed into zeros */
+    Test_Hex(nonce, "000000090000004a00000000");
+    Test_Hex(expected, "10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+                       "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e");
+    memset(out, 0, 64);
+    ChaCha20_Xor(key, nonce, 1, out, out, 64);
+    CHECK(memcmp(out, expected, 64) == 0);
+
+    /* 2.4.2 */
+    Test_Hex(nonce, "000000000000004a00000000");
+    Test_Hex(expected, "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b"
+                       "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8"
+                       "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+                       "5af90bbf74a35be6b40b8eedf2785e42874d");
+    CHECK(SW_CHACHA20_Xor(key, nonce, 1, (const uint8_t *)sunscreen, out, 114) == 0);
+    CHECK(memcmp(out, expected, 114) == 0);
+    ChaCha20_Xor(key, nonce, 1, out, out, 114);
+    CHECK(memcmp(out, sunscreen, 114) == 0);
+
+    /* A.1 #1: zero key and nonce, block 0 */
+    memset(key, 0, sizeof(key));
+    memset(nonce, 0, sizeof(nonce));
+    Test_Hex(expected, "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+                       "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586");
+    memset(out, 0, 64);
+    ChaCha20_Xor(key, nonce, 0, out, out, 64);
+    CHECK(memcmp(out, expected, 64) == 0);
+}
+
+/* 2.5.2, fed in uneven pieces as the install's streaming pass does */
+static void Test_Poly1305(void) {
+    static const char msg[] = "Cryptographic Forum Research Group";
+    uint8_t key[32], expected[16], tag[16];
+    BL_PolyCtx_t ctx;
+
+    Test_Hex(key, "85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b");
+    Test_Hex(expected, "a8061dc1305136c6c22b8baf0c0127a9");
+    CHECK(SW_POLY1305_Init(&ctx, key) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, (const uint8_t *)msg, 34) == 0);
+    CHECK(SW_POLY1305_Final(&ctx, tag) == 0);
+    CHECK(memcmp(tag, expected, 16) == 0);
+
+    CHECK(SW_POLY1305_Init(&ctx, key) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, (const uint8_t *)msg, 5) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, (const uint8_t *)msg + 5, 16) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, (const uint8_t *)msg + 21, 13) == 0);
+    CHECK(SW_POLY1305_Final(&ctx, tag) == 0);
+    CHECK(memcmp(tag, expected, 16) == 0);
+}
+
+/*
+ * 2.8.2: the one-time key is block 0, the data starts at block 1, and
+ * the MAC runs over AAD, ciphertext, their zero padding and the lengths,
+ * as BL_Aead_Begin()/BL_Aead_Finish() do with the header as AAD.
+ */
+static void Test_Aead(void) {
+    static const char sunscreen[] =
+        "Ladies and Gentlemen of the class of '99: If I could offer you only one "
+        "tip for the future, sunscreen would be it.";
+    static const uint8_t zero[32] = { 0 };
+    uint8_t key[32], nonce[12], aad[12], poly_key[32];
+    uint8_t expected[114], out[114], expected_tag[16], tag[16];
+    uint64_t lengths[2] = { sizeof(aad), sizeof(out) };
+    BL_PolyCtx_t ctx;
+
+    for (int i = 0; i < 32; i++)
+        key[i] = (uint8_t)(0x80 + i);
+    Test_Hex(nonce, "070000004041424344454647");
+    Test_Hex(aad, "50515253c0c1c2c3c4c5c6c7");
+    Test_Hex(expected, "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+                       "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+                       "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+                       "3ff4def08e4b7a9de576d26586cec64b6116");
+    Test_Hex(expected_tag, "1ae10b594f09e26a7e902ecbd0600691");
+
+    CHECK(SW_CHACHA20_Xor(key, nonce, 0, zero, poly_key, 32) == 0);
+    CHECK(SW_CHACHA20_Xor(key, nonce, 1, (const uint8_t *)sunscreen, out, 114) == 0);
+    CHECK(memcmp(out, expected, 114) == 0);
+
+    CHECK(SW_POLY1305_Init(&ctx, poly_key) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, aad, sizeof(aad)) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, zero, 16 - sizeof(aad)) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, out, sizeof(out)) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, zero, (16 - sizeof(out) % 16) % 16) == 0);
+    CHECK(SW_POLY1305_Update(&ctx, (const uint8_t *)lengths, sizeof(lengths)) == 0);
+    CHECK(SW_POLY1305_Final(&ctx, tag) == 0);
+    CHECK(memcmp(tag, expected_tag, 16) == 0);
+}
+
+/* The backup and decrypt passes start each chunk at its own block counter */
+static void Test_Counter(void) {
+    static uint8_t in[4096], whole[4096], part[4096];
+    uint8_t key[32], nonce[12];
+    uint32_t seed = 3;
+
+    Test_Fill(&seed, key, sizeof(key));
+    Test_Fill(&seed, nonce, sizeof(nonce));
+    Test_Fill(&seed, in, sizeof(in));
+
+    ChaCha20_Xor(key, nonce, 7, in, whole, sizeof(in));
+    for (uint32_t i = 0; i < sizeof(in); i += 256)
+        ChaCha20_Xor(key, nonce, 7 + i / 64, in + i, part + i, 256);
+    CHECK(memcmp(whole, part, sizeof(in)) == 0);
+
+    /* A tail shorter than a block */
+    ChaCha20_Xor(key, nonce, 7, in, part, 100);
+    CHECK(memcmp(whole, part, 100) == 0);
+}
+
+static double Mb_Per_S(uint64_t ns) {
+    return (double)BENCH_SIZE * BENCH_RUNS / 1e6 / ((double)ns / 1e9);
+}
+
+static void Bench(void) {
+    static uint8_t in[BENCH_SIZE], out[BENCH_SIZE];
+    uint8_t key[32], nonce[12];
+    uint32_t seed = 9;
+    BL_AesCtx_t ctx;
+    struct tc_aes_key_sched_struct sched;
+
+    Test_Fill(&seed, key, sizeof(key));
+    Test_Fill(&seed, nonce, sizeof(nonce));
+    Test_Fill(&seed, in, sizeof(in));
+    SW_AES_Init(&ctx, key);
+    tc_aes128_set_encrypt_key(&sched, key);
+
+    uint64_t t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        SW_CHACHA20_Xor(key, nonce, 0, in, out, BENCH_SIZE);
+    uint64_t chacha = Test_Now_Ns() - t;
+
+    t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        SW_AES_ECB_Encrypt(&ctx, in, out, BENCH_SIZE);
+    uint64_t ecb_enc = Test_Now_Ns() - t;
+
+    t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        SW_AES_ECB_Decrypt(&ctx, in, out, BENCH_SIZE);
+    uint64_t ecb_dec = Test_Now_Ns() - t;
+
+    /* Rollback with TinyCrypt, the backend the option was measured against */
+    t = Test_Now_Ns();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        for (uint32_t i = 0; i < BENCH_SIZE; i += 16)
+            tc_aes_decrypt(out + i, in + i, &sched);
+    uint64_t tc_dec = Test_Now_Ns() - t;
+
+    printf("ChaCha20 %.0f MB/s; %s ECB encrypt %.0f MB/s, decrypt %.0f MB/s; "
+           "TinyCrypt ECB decrypt %.0f MB/s\n",
+           Mb_Per_S(chacha), BL_AES_TTABLE ? "T-table" : "TinyCrypt",
+           Mb_Per_S(ecb_enc), Mb_Per_S(ecb_dec), Mb_Per_S(tc_dec));
+    CHECK(chacha < tc_dec);
+}
+
+int main(void) {
+    Test_Rfc8439();
+    Test_Poly1305();
+    Test_Aead();
+    Test_Counter();
+    Bench();
+    return TEST_EXIT();
+}
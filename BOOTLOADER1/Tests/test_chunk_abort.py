@@ -0,0 +1,76 @@
+"""Test (user-020): a corrupt chunk stops the check at that chunk.
+
+Damages chunk k of a --chunked package and installs it. The bootloader
+must report chunk k, and the crypto reads of S6 must end with chunk k:
+the manifest (header, IV and digests) plus chunk k and those before it,
+read once by the separate verify build and at most three times (hashed,
+decrypted, hashed again by the check pass) by the fused build, which
+stages while it checks. S5 keeps the old image, S6 is erased and the
+stage wiped. Covers AES-CBC and AES-CTR packages.
+"""
+
+import argparse
+import struct
+
+from sim import S5, S6, S7, EXIT_APP, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+CHUNK = 4096
+HEADER_IV = 32
+DIGEST = 32
+
+
+def layout(package):
+    """(ciphertext bytes, chunk count) from the header's footer offset."""
+    footer_offset = struct.unpack_from("<I", package, 4)[0]
+    n = 1
+    while True:
+        data_len = footer_offset - HEADER_IV - DIGEST * n
+        if (data_len + CHUNK - 1) // CHUNK == n:
+            return data_len, n
+        n += 1
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--fused", required=True, help="bootloader_posix with BL_FUSED_VERIFY=1")
+    parser.add_argument("--separate", required=True, help="bootloader_posix with BL_FUSED_VERIFY=0")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    new = make_app(100 * 1024 + 7, seed=2)
+
+    with Sim(args.fused) as sim:
+        for cipher in ([], ["--ctr"]):
+            package = sim.package(new, "--chunked", *cipher)
+            data_len, chunks = layout(package)
+            manifest = HEADER_IV + DIGEST * chunks
+
+            for k in (0, 1, chunks // 2, chunks - 1):
+                bad = bytearray(package)
+                bad[HEADER_IV + k * CHUNK + min(100, data_len - k * CHUNK - 1)] ^= 1
+                for build, bootloader, passes in (("fused", args.fused, 3),
+                                                  ("separate", args.separate, 1)):
+                    name = f"{' '.join(cipher) or 'AES-CBC'}, {build}, chunk {k} of {chunks}"
+                    sim.erase_all()
+                    sim.write(S5, old)
+                    sim.write(S6, bytes(bad))
+                    sim.set_state(STATE_UPDATE_REQ)
+                    result = sim.run(bootloader=bootloader)
+
+                    read = min((k + 1) * CHUNK, data_len)
+                    t.check(f"Chunk {k} digest mismatch" in result.out, f"{name}: reported")
+                    t.check(manifest + read <= result.reads["S6"] <= manifest + passes * read,
+                            f"{name}: S6 reads end at the chunk ({result.reads['S6']} bytes, "
+                            f"data {data_len})")
+                    if build == "separate":
+                        t.check(result.reads["S6"] == manifest + read,
+                                f"{name}: each chunk up to it hashed once")
+                    t.check(result.rc == EXIT_APP and sim.holds(S5, old), f"{name}: S5 unchanged")
+                    t.check(sim.read(S6, CHUNK) == b"\xff" * CHUNK, f"{name}: S6 erased")
+                    t.check(sim.read(S7, CHUNK) == b"\xff" * CHUNK, f"{name}: stage wiped")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+/*
+ * test_config_log.c
+ *
+ * The config log as an application uses it, on the simulator flash:
+ * requests across sector rotations, torn records, and a bare
+ * BootConfig_t written the old way over a log that has moved on to the
+ * second sector, which must be read and then replaced by the next record.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "BL_ConfigLog.h"
+#include "mem_layout.h"
+#include "system_interface.h"
+
+static const Bootloader_Interface_t *real;
+static uint32_t writes;
+
+static int Count_Write(uint32_t addr, const uint8_t *data, uint32_t length) {
+    writes++;
+    return real->Flash_Write(addr, data, length);
+}
+
+static const BL_ConfigRecord_t *Record(uint32_t base, uint32_t index) {
+    return (const BL_ConfigRecord_t *)(uintptr_t)(base + index * sizeof(BL_ConfigRecord_t));
+}
+
+static uint32_t Read_Status(const BL_ConfigFlash_t *flash) {
+    BootConfig_t cfg;
+    CHECK(BL_Config_Read(flash, &cfg) == 0);
+    return cfg.system_status;
+}
+
+/* What an application built before the log did to request an update */
+static void Write_Bare(const BL_ConfigFlash_t *flash, uint32_t state, uint32_t version) {
+    uint32_t bare[3] = { CONFIG_MAGIC, state, version };
+
+    CHECK(real->Flash_Erase(flash->addr, flash->size) == 0);
+    CHECK(real->Flash_Write(flash->addr, (const uint8_t *)bare, sizeof(bare)) == 0);
+}
+
+int main(void) {
+    uint32_t slots = CONFIG_SECTOR_SIZE / sizeof(BL_ConfigRecord_t);
+    char path[] = "/tmp/bl_config_log_XXXXXX";
+    BootConfig_t cfg;
+
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+    setenv("BL_FLASH_IMAGE", path, 1);
+    real = Sys_GetInterface();
+    real->Init();
+
+    BL_ConfigFlash_t flash = {
+        .addr     = CONFIG_SECTOR_ADDR,
+        .alt_addr = CONFIG_ALT_SECTOR_ADDR,
+        .size     = CONFIG_SECTOR_SIZE,
+        .Erase    = real->Flash_Erase,
+        .Write    = Count_Write,
+    };
+
+    /* Erased sectors: defaults */
+    CHECK(BL_Config_Read(&flash, &cfg) == 1);
+    CHECK(cfg.system_status == STATE_NORMAL && cfg.current_version == 0);
+    CHECK(BL_Config_Next_Seq(&flash) == 1);
+
+    /* The application's request is one record */
+    CHECK(BL_Config_Request(&flash, STATE_UPDATE_REQ) == 1);
+    CHECK(Read_Status(&flash) == STATE_UPDATE_REQ);
+    CHECK(Record(CONFIG_SECTOR_ADDR, 0)->seq == 1);
+
+    /* The same config again writes nothing */
+    writes = 0;
+    CHECK(BL_Config_Request(&flash, STATE_UPDATE_REQ) == 1);
+    CHECK(writes == 0);
+
+    /* Fill the first sector: the next record goes to the second, erased */
+    for (uint32_t i = 1; i <= slots; i++) {
+        BL_Config_Read(&flash, &cfg);
+        cfg.current_version = i;
+        cfg.system_status   = (i & 1) ? STATE_NORMAL : STATE_ROLLBACK;
+        CHECK(BL_Config_Append(&flash, &cfg) == 1);
+    }
+    CHECK(Record(CONFIG_ALT_SECTOR_ADDR, 0)->seq == slots + 1);
+    CHECK(BL_Config_Read(&flash, &cfg) == 0);
+    CHECK(cfg.current_version == slots && cfg.system_status == STATE_NORMAL);
+    CHECK(BL_Config_Next_Seq(&flash) == slots + 2);
+
+    /* A record torn by a reset: the one before it counts */
+    BL_ConfigRecord_t torn = *Record(CONFIG_ALT_SECTOR_ADDR, 0);
+    torn.seq++;
+    torn.cfg.system_status = STATE_UPDATE_REQ;
+    CHECK(real->Flash_Write(CONFIG_ALT_SECTOR_ADDR + sizeof(torn), (const uint8_t *)&torn, 48) == 0);
+    CHECK(Read_Status(&flash) == STATE_NORMAL);
+    CHECK(BL_Config_Request(&flash, STATE_ROLLBACK) == 1);
+    CHECK(Read_Status(&flash) == STATE_ROLLBACK);
+
+    /*
+     * An old application erases the first sector and writes a bare config
+     * while the log is in the second: the request is seen, and the next
+     * record replaces it in the first sector.
+     */
+    CHECK(BL_Config_Request(&flash, STATE_NORMAL) == 1);
+    Write_Bare(&flash, STATE_UPDATE_REQ, 0x0100);
+    CHECK(BL_Config_Read(&flash, &cfg) == 0);
+    CHECK(cfg.system_status == STATE_UPDATE_REQ && cfg.current_version == 0x0100);
+    CHECK(cfg.current_size == 0 && cfg.swap.magic == 0);
+
+    uint32_t seq = BL_Config_Next_Seq(&flash);
+    cfg.system_status = STATE_NORMAL;
+    CHECK(BL_Config_Append(&flash, &cfg) == 1);
+    CHECK(Record(CONFIG_SECTOR_ADDR, 0)->seq == seq);
+    CHECK(Record(CONFIG_SECTOR_ADDR, 1)->seq == 0xFFFFFFFF);
+    CHECK(Read_Status(&flash) == STATE_NORMAL);
+
+    /* The same with the log in the first sector and older records in the second */
+    Write_Bare(&flash, STATE_ROLLBACK, 0x0200);
+    CHECK(Read_Status(&flash) == STATE_ROLLBACK);
+    CHECK(BL_Config_Request(&flash, STATE_UPDATE_REQ) == 1);
+    CHECK(Read_Status(&flash) == STATE_UPDATE_REQ);
+    CHECK(BL_Config_Read(&flash, &cfg) == 0 && cfg.current_version == 0x0200);
+
+    unlink(path);
+    return TEST_EXIT();
+}
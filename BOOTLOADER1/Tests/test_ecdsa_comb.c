@@ -0,0 +1,141 @@
+/*
+ * test_ecdsa_comb.c
+ *
+ * ECDSA_Comb_Verify() against uECC_verify() on random signatures under
+ * the test key, valid and mutated, for 20, 32 and 48-byte hashes. Prints
+ * the cycles per verify of both and checks that the comb is faster.
+ */
+
+#include <string.h>
+
+#include "test_util.h"
+#include "ecdsa_comb.h"
+#include "keys.h"
+#include "ecc.h"
+#include "ecc_dsa.h"
+
+#define SIGNATURES  64U
+#define BENCH_RUNS  20U
+
+/* Tests/keys/private.pem */
+static const char test_private[] =
+    "8ee242ff22db3878d7e63e6dfe37604589b473c34c0ea7ead0ba16abede450b9";
+
+/* P-256 group order */
+static const char order_n[] =
+    "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551";
+
+static uint32_t rng_state = 17;
+
+static int Test_Rng(uint8_t *dest, unsigned int size) {
+    Test_Fill(&rng_state, dest, size);
+    return 1;
+}
+
+static uint32_t agreed, accepted;
+
+/* Both verifiers must give the same answer; returns it */
+static int Verify_Both(const uint8_t *hash, uint32_t hash_len, const uint8_t sig[64]) {
+    int comb = ECDSA_Comb_Verify(&ECDSA_public_key_comb, hash, hash_len, sig);
+    int ref  = uECC_verify(ECDSA_public_key_xy, hash, hash_len, sig, uECC_secp256r1());
+
+    CHECK(comb == ref);
+    agreed++;
+    accepted += (ref == 1);
+    return ref;
+}
+
+/* s -> n - s: the other valid signature for the same r */
+static void Negate_S(uint8_t sig[64]) {
+    uint8_t n[32];
+    int borrow = 0;
+
+    Test_Hex(n, order_n);
+    for (int i = 31; i >= 0; i--) {
+        int d = n[i] - sig[32 + i] - borrow;
+        borrow = d < 0;
+        sig[32 + i] = (uint8_t)d;
+    }
+}
+
+static void Test_Signatures(const uint8_t private_key[32], uint32_t hash_len) {
+    static const uint8_t other_key[32] = { [31] = 1 };
+    uint8_t hash[48], sig[64], bad[64], other[48];
+
+    for (uint32_t i = 0; i < SIGNATURES; i++) {
+        Test_Fill(&rng_state, hash, sizeof(hash));
+        CHECK(uECC_sign(private_key, hash, hash_len, sig, uECC_secp256r1()) == 1);
+        CHECK(Verify_Both(hash, hash_len, sig) == 1);
+
+        /* One bit of the hash (of its first 32 bytes, the rest is cut
+         * off), of r or of s */
+        uint32_t bit = Test_Rand(&rng_state);
+        memcpy(other, hash, sizeof(other));
+        other[(bit >> 3) % (hash_len < 32 ? hash_len : 32)] ^= (uint8_t)(1U << (bit & 7));
+        CHECK(Verify_Both(other, hash_len, sig) == 0);
+
+        memcpy(bad, sig, 64);
+        bad[(bit >> 3) % 64] ^= (uint8_t)(1U << (bit & 7));
+        CHECK(Verify_Both(hash, hash_len, bad) == 0);
+
+        /* r or s out of range */
+        memcpy(bad, sig, 64);
+        memset(bad + 32 * (i & 1), 0, 32);
+        CHECK(Verify_Both(hash, hash_len, bad) == 0);
+        memcpy(bad, sig, 64);
+        Test_Hex(bad + 32 * (i & 1), order_n);
+        CHECK(Verify_Both(hash, hash_len, bad) == 0);
+        memset(bad + 32 * (i & 1), 0xFF, 32);
+        CHECK(Verify_Both(hash, hash_len, bad) == 0);
+
+        /* (r, n - s) is valid too */
+        memcpy(bad, sig, 64);
+        Negate_S(bad);
+        CHECK(Verify_Both(hash, hash_len, bad) == 1);
+
+        /* Random bytes, and a signature by another key */
+        Test_Fill(&rng_state, bad, 64);
+        CHECK(Verify_Both(hash, hash_len, bad) == 0);
+        CHECK(uECC_sign(other_key, hash, hash_len, bad, uECC_secp256r1()) == 1);
+        CHECK(Verify_Both(hash, hash_len, bad) == 0);
+    }
+}
+
+static void Bench(const uint8_t private_key[32]) {
+    uint8_t hash[32], sig[64];
+    uint64_t comb = 0, ref = 0;
+
+    Test_Fill(&rng_state, hash, sizeof(hash));
+    uECC_sign(private_key, hash, sizeof(hash), sig, uECC_secp256r1());
+
+    for (uint32_t r = 0; r < BENCH_RUNS; r++) {
+        uint64_t t = Test_Cycles();
+        CHECK(ECDSA_Comb_Verify(&ECDSA_public_key_comb, hash, sizeof(hash), sig) == 1);
+        comb += Test_Cycles() - t;
+
+        t = Test_Cycles();
+        CHECK(uECC_verify(ECDSA_public_key_xy, hash, sizeof(hash), sig, uECC_secp256r1()) == 1);
+        ref += Test_Cycles() - t;
+    }
+
+    printf("Verify: comb %.2f Mcycles, uECC_verify %.2f Mcycles (%.1fx)\n",
+           (double)comb / BENCH_RUNS / 1e6, (double)ref / BENCH_RUNS / 1e6,
+           (double)ref / (double)comb);
+    CHECK(comb < ref);
+}
+
+int main(void) {
+    static const uint32_t hash_lens[] = { 20, 32, 48 };
+    uint8_t private_key[32];
+
+    uECC_set_rng(Test_Rng);
+    Test_Hex(private_key, test_private);
+    CHECK(memcmp(ECDSA_public_key_comb.public_key, ECDSA_public_key_xy, 64) == 0);
+
+    for (unsigned int i = 0; i < sizeof(hash_lens) / sizeof(hash_lens[0]); i++)
+        Test_Signatures(private_key, hash_lens[i]);
+    printf("%u signatures checked, %u valid\n", (unsigned int)agreed, (unsigned int)accepted);
+
+    Bench(private_key);
+    return TEST_EXIT();
+}
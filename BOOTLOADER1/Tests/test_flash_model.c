@@ -0,0 +1,117 @@
+/*
+ * test_flash_model.c
+ *
+ * Checks the flash model of system_driver_posix.c against the rules of
+ * the STM32F746 part and of STM32_Flash_Write(): sector erase, 1 -> 0
+ * programming, program-unit alignment and the per-unit program time.
+ * Run once per BL_SIM_PROGRAM_WIDTH (see CMakeLists.txt).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "system_interface.h"
+
+#define S5    0x08040000U
+#define S6    0x08080000U
+#define CFG   0x08010000U
+
+static const Bootloader_Interface_t *sys;
+
+static uint8_t Erased(uint32_t addr, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (((const uint8_t *)(uintptr_t)addr)[i] != 0xFF)
+            return 0;
+    }
+    return 1;
+}
+
+/* Simulated flash time of a call, in ms (wall-clock time is only a few ms) */
+static uint32_t Program_Ms(uint32_t addr, const uint8_t *data, uint32_t len, int *ret) {
+    uint32_t start = sys->GetTick();
+    *ret = sys->Flash_Write(addr, data, len);
+    return sys->GetTick() - start;
+}
+
+int main(void) {
+    static uint8_t data[65536];
+    char path[] = "/tmp/bl_flash_model_XXXXXX";
+    const char *env = getenv("BL_SIM_PROGRAM_WIDTH");
+    uint32_t width = env ? (uint32_t)strtoul(env, NULL, 0) : 4;
+    uint32_t seed = 1;
+    int ret;
+
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+    setenv("BL_FLASH_IMAGE", path, 1);
+
+    sys = Sys_GetInterface();
+    sys->Init();
+
+    /* A new image reads erased */
+    CHECK(Erased(S5, 0x40000));
+
+    /* Aligned runs of any length; only the tail may be short */
+    Test_Fill(&seed, data, sizeof(data));
+    CHECK(sys->Flash_Write(S5, data, 16) == 0);
+    CHECK(memcmp((void *)(uintptr_t)S5, data, 16) == 0);
+    CHECK(sys->Flash_Write(S5 + 16, data + 16, 7) == 0);
+    CHECK(memcmp((void *)(uintptr_t)(S5 + 16), data + 16, 7) == 0);
+
+    /* Programming cannot set bits again */
+    static const uint8_t ones[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    static const uint8_t zeros[8] = { 0 };
+    CHECK(sys->Flash_Write(S5, ones, 8) != 0);
+    CHECK(sys->Flash_Write(S5 + 64, zeros, 8) == 0);
+    CHECK(sys->Flash_Write(S5 + 64, zeros, 8) == 0);
+
+    /* A start between units is refused and leaves flash as it was */
+    if (width > 1) {
+        CHECK(sys->Flash_Write(S5 + 256 + width / 2, data, 16) != 0);
+        CHECK(Erased(S5 + 256, 64));
+        CHECK(sys->Flash_Write(S5 + 257, data, 1) != 0);
+    } else {
+        CHECK(sys->Flash_Write(S5 + 257, data, 1) == 0);
+    }
+    CHECK(sys->Flash_Write(S5 + 256 + width, data, 16) == 0);
+
+    /* Outside the 1 MB part */
+    CHECK(sys->Flash_Write(0x07FFFFF0, data, 16) != 0);
+    CHECK(sys->Flash_Write(0x080FFFF8, data, 16) != 0);
+    CHECK(sys->Flash_Erase(0x08100000, 16) != 0);
+
+    /* One program operation (16 us) per unit: 64 KB in 65536 / width units */
+    uint32_t expect = (uint32_t)(65536ULL / width * 16U / 1000U);
+    uint32_t ms = Program_Ms(S6, data, sizeof(data), &ret);
+    CHECK(ret == 0);
+    CHECK(ms >= expect && ms <= expect + 50);
+    printf("64 KB in %u-byte units: %u ms of flash time (%u expected)\n",
+           (unsigned int)width, (unsigned int)ms, (unsigned int)expect);
+
+    /* 8 KB as 1024 writes of 7 bytes: the tail costs one unit per halving */
+    uint32_t tail_units = (width == 8) ? 3 : (width == 4) ? 3 : (width == 2) ? 4 : 7;
+    uint32_t start = sys->GetTick();
+    for (uint32_t i = 0; i < 1024; i++)
+        CHECK(sys->Flash_Write(S6 + 0x20000 + i * 8, data, 7) == 0);
+    ms = sys->GetTick() - start;
+    expect = 1024U * tail_units * 16U / 1000U;
+    CHECK(ms >= expect && ms <= expect + 50);
+
+    /* Erase takes whole sectors: 32 KB sector 2 for any range inside it */
+    CHECK(sys->Flash_Write(CFG, data, 4096) == 0);
+    CHECK(sys->Flash_Write(CFG + 0x7000, data, 4096) == 0);
+    CHECK(sys->Flash_Erase(CFG + 0x100, 16) == 0);
+    CHECK(Erased(CFG, 0x8000));
+
+    /* A range across a boundary erases both sectors, and nothing else */
+    CHECK(sys->Flash_Erase(S5 + 0x3FFF0, 0x20) == 0);
+    CHECK(Erased(S5, 0x40000));
+    CHECK(Erased(S6, 0x40000));
+    CHECK(Erased(0x08018000, 0x8000));
+
+    unlink(path);
+    return TEST_EXIT();
+}
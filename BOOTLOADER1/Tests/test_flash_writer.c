@@ -0,0 +1,120 @@
+/*
+ * test_flash_writer.c
+ *
+ * Counts the Flash_Write calls a crypto pass makes with and without
+ * BL_FlashWriter, on the simulator, and checks that the writer programs
+ * the same bytes in chunks that never cross a BL_WRITE_BUF_SIZE boundary.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "test_util.h"
+#include "BL_FlashWriter.h"
+#include "mem_layout.h"
+
+#define S5      0x08040000U
+#define S6      0x08080000U
+#define IMAGE   (75U * 1024U)
+#define BLOCK   16U
+
+static const Bootloader_Interface_t *real;
+static Bootloader_Interface_t counted;
+static uint32_t calls;
+static uint32_t straddles;
+
+static int Count_Write(uint32_t addr, const uint8_t *data, uint32_t length) {
+    calls++;
+    if ((addr % BL_WRITE_BUF_SIZE) + length > BL_WRITE_BUF_SIZE)
+        straddles++;
+    return real->Flash_Write(addr, data, length);
+}
+
+/* The decrypt loop before the writer: one driver call per AES block */
+static uint32_t Write_Direct(uint32_t dest, const uint8_t *data, uint32_t len) {
+    calls = 0;
+    for (uint32_t i = 0; i < len; i += BLOCK)
+        CHECK(counted.Flash_Write(dest + i, data + i, BLOCK) == 0);
+    return calls;
+}
+
+static uint32_t Write_Buffered(BL_FlashWriter_t *w, uint32_t dest, const uint8_t *data, uint32_t len) {
+    calls = 0;
+    BL_Writer_Init(w, &counted);
+    for (uint32_t i = 0; i < len; i += BLOCK)
+        CHECK(BL_Writer_Put(w, dest + i, data + i, BLOCK) == 0);
+    CHECK(BL_Writer_Flush(w) == 0);
+    return calls;
+}
+
+int main(void) {
+    static uint8_t data[IMAGE];
+    uint8_t *ram = (uint8_t *)(uintptr_t)RAM_STAGE_ADDR;  /* Mapped by the simulator */
+    static BL_FlashWriter_t w;
+    char path[] = "/tmp/bl_flash_writer_XXXXXX";
+    uint32_t seed = 7;
+
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+    setenv("BL_FLASH_IMAGE", path, 1);
+
+    real = Sys_GetInterface();
+    counted = *real;
+    counted.Flash_Write = Count_Write;
+    real->Init();
+    Test_Fill(&seed, data, sizeof(data));
+
+    uint32_t direct   = Write_Direct(S5, data, IMAGE);
+    uint32_t buffered = Write_Buffered(&w, S6, data, IMAGE);
+    printf("75 KB in 16-byte blocks: %u Flash_Write calls direct, %u through BL_FlashWriter\n",
+           (unsigned int)direct, (unsigned int)buffered);
+
+    CHECK(direct == IMAGE / BLOCK);
+    CHECK(buffered == IMAGE / BL_WRITE_BUF_SIZE);
+    CHECK(straddles == 0);
+    CHECK(memcmp((void *)(uintptr_t)S5, data, IMAGE) == 0);
+    CHECK(memcmp((void *)(uintptr_t)S6, data, IMAGE) == 0);
+
+    /* A start inside a chunk only shortens the first call */
+    real->Flash_Erase(S6, IMAGE);
+    CHECK(Write_Buffered(&w, S6 + 0x30, data, 4096) == 5);
+    CHECK(straddles == 0);
+    CHECK(memcmp((void *)(uintptr_t)(S6 + 0x30), data, 4096) == 0);
+
+    /* A gap flushes what is buffered; the tail needs no whole chunk */
+    real->Flash_Erase(S6, IMAGE);
+    calls = 0;
+    BL_Writer_Init(&w, &counted);
+    CHECK(BL_Writer_Put(&w, S6, data, 100) == 0);
+    CHECK(calls == 0);
+    CHECK(BL_Writer_Put(&w, S6 + 0x200, data + 0x200, 100) == 0);
+    CHECK(calls == 1);
+    CHECK(BL_Writer_Flush(&w) == 0);
+    CHECK(calls == 2);
+    CHECK(BL_Writer_Flush(&w) == 0);
+    CHECK(calls == 2);
+    CHECK(memcmp((void *)(uintptr_t)(S6 + 0x200), data + 0x200, 100) == 0);
+    CHECK(*(const uint8_t *)(uintptr_t)(S6 + 100) == 0xFF);
+
+    /* A chunk that fails reports the first byte that did not program */
+    memset(ram, 0xFF, 0x400);
+    real->Flash_Erase(S6, IMAGE);
+    CHECK(real->Flash_Write(S6 + 0x80, (const uint8_t *)"\0\0\0\0", 4) == 0);
+    BL_Writer_Init(&w, &counted);
+    CHECK(BL_Writer_Put(&w, S6, ram, 0x400) != 0);
+    CHECK(w.fail_addr == S6 + 0x80);
+    CHECK(BL_Writer_Put(&w, S6 + 0x400, ram, 16) != 0);
+
+    /* Without an interface the chunks go to RAM, and no driver call is made */
+    calls = 0;
+    BL_Writer_Init(&w, NULL);
+    CHECK(BL_Writer_Put(&w, RAM_STAGE_ADDR, data, 4096) == 0);
+    CHECK(BL_Writer_Flush(&w) == 0);
+    CHECK(calls == 0);
+    CHECK(memcmp(ram, data, 4096) == 0);
+
+    unlink(path);
+    return TEST_EXIT();
+}
@@ -0,0 +1,103 @@
+"""Test (user-007): install, rollback and roll-forward at boundary image sizes.
+
+Sizes: 16-byte multiples from one AES block up, one under the largest
+image whose AES-CBC package fits a slot, that largest image, and an old
+image filling the whole slot (provisioned without a package, so its
+length is unknown). No byte past the image is programmed into S5. Images too short for a vector table, and packages
+larger than a slot, are refused by the generator; signed packages
+claiming such sizes are refused by the bootloader.
+"""
+
+import argparse
+import struct
+
+from sim import S5, S6, SLOT_SIZE, EXIT_APP, STATE_ROLLBACK, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+# Header + IV + PKCS7-padded image + footer must fit the slot
+FOOTER_SIZE = 76
+LARGEST = (SLOT_SIZE - 16 - 16 - FOOTER_SIZE) // 16 * 16 - 1
+SIZES = [16, 32, 4096, 65536, SLOT_SIZE // 2, LARGEST - 15, LARGEST - 1, LARGEST]
+
+
+def erased(sim, addr, size):
+    return sim.read(addr, size) == b"\xff" * size
+
+
+def round_trip(t, sim, old, new, name):
+    """Installs new over old, rolls back, then rolls forward again."""
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, sim.package(new))
+    sim.set_state(STATE_UPDATE_REQ)
+    result = sim.run()
+    t.check(result.rc == EXIT_APP and sim.holds(S5, new), f"{name}: installs ({result})")
+    if len(new) < SLOT_SIZE:
+        t.check(erased(sim, S5 + len(new), min(SLOT_SIZE - len(new), 4096)),
+                f"{name}: nothing left behind the image")
+
+    sim.set_state(STATE_ROLLBACK)
+    result = sim.run()
+    t.check(result.rc == EXIT_APP and sim.holds(S5, old), f"{name}: rolls back ({result})")
+
+    sim.set_state(STATE_ROLLBACK)
+    result = sim.run()
+    t.check(result.rc == EXIT_APP and sim.holds(S5, new), f"{name}: rolls forward ({result})")
+
+
+def rejected(t, sim, old, package, name):
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, package)
+    sim.set_state(STATE_UPDATE_REQ)
+    result = sim.run()
+    t.check("Error Code: 3" in result.out, f"{name}: refused as BL_ERR_IMAGE_SIZE_BAD")
+    t.check(sim.holds(S5, old) and erased(sim, S6, 4096), f"{name}: S5 kept, S6 erased")
+    t.check(result.rc == EXIT_APP, f"{name}: resets into the old image")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True, help="bootloader_posix")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    with Sim(args.bootloader) as sim:
+        for size in SIZES:
+            round_trip(t, sim, old, make_app(size, seed=size), f"{size} bytes")
+        round_trip(t, sim, make_app(SLOT_SIZE, seed=5), make_app(4096, seed=6), "full-slot old image")
+
+        # The cipher padding of an odd size is not installed, in any format,
+        # and the stream ciphers pad only to the footer alignment
+        new = make_app(4099, seed=7)
+        for opts in ([], ["--ctr"], ["--chacha20"], ["--aead"], ["--chunked"], ["--overwrite"], ["--lz4"]):
+            sim.erase_all()
+            sim.write(S5, old)
+            package = sim.package(new, *opts)
+            if opts in (["--ctr"], ["--chacha20"]):
+                # Header + IV + image to the 4-byte footer alignment + footer
+                t.check(len(package) == 16 + 16 + 4100 + FOOTER_SIZE,
+                        f"4099 bytes {opts[0]}: stream cipher package is not block-padded")
+            sim.write(S6, package)
+            sim.set_state(STATE_UPDATE_REQ)
+            result = sim.run()
+            t.check(result.rc == EXIT_APP and sim.holds(S5, new) and erased(sim, S5 + len(new), 4096),
+                    f"4099 bytes {' '.join(opts)}: installs without padding")
+
+        for size in (0, 4, LARGEST + 1):
+            try:
+                sim.package(make_app(size, seed=size))
+                t.check(False, f"{size} bytes: generator refuses")
+            except RuntimeError:
+                pass
+
+        # Header image_size (offset 12) edited and signed again
+        package = sim.package(make_app(16, seed=16))
+        for size in (0, 4, SLOT_SIZE + 1):
+            bad = sim.resign(package[:12] + struct.pack("<I", size) + package[16:])
+            rejected(t, sim, old, bad, f"image_size {size}")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,170 @@
+/*
+ * test_keys.c
+ *
+ * Keys of the host tests, generated by Key/extract_pubkey.py from
+ * Tests/keys. The private key is committed so the tests can sign
+ * packages: never use these keys on a device.
+ */
+
+#include "keys.h"
+
+/* ECDSA Public Key (from public.pem) */
+const uint8_t ECDSA_public_key_xy[64] = {
+    /* X Coordinate */
+    0xCF, 0x17, 0xAB, 0x3F, 0x7D, 0x00, 0xB2, 0xA7,
+    0x86, 0x88, 0xCD, 0x45, 0x01, 0x13, 0x60, 0x77,
+    0x71, 0x90, 0x4B, 0xA4, 0x28, 0xC0, 0x50, 0x4B,
+    0x62, 0x0D, 0x4A, 0x94, 0xD8, 0x6D, 0x9D, 0x1D,
+
+    /* Y Coordinate */
+    0x77, 0x79, 0x0F, 0x64, 0xA1, 0x57, 0xE3, 0x2F,
+    0x0E, 0x1F, 0x39, 0x58, 0x66, 0xC5, 0x47, 0x15,
+    0x6C, 0x4D, 0xF7, 0x31, 0xFF, 0xDD, 0x6A, 0x58,
+    0x01, 0x55, 0xCF, 0x8D, 0x3A, 0x1E, 0x6B, 0x1E
+};
+
+/* Public key comb table (from public.pem) */
+const ECDSA_CombTable_t ECDSA_public_key_comb = {
+    .public_key = {
+        0xCF, 0x17, 0xAB, 0x3F, 0x7D, 0x00, 0xB2, 0xA7,
+        0x86, 0x88, 0xCD, 0x45, 0x01, 0x13, 0x60, 0x77,
+        0x71, 0x90, 0x4B, 0xA4, 0x28, 0xC0, 0x50, 0x4B,
+        0x62, 0x0D, 0x4A, 0x94, 0xD8, 0x6D, 0x9D, 0x1D,
+        0x77, 0x79, 0x0F, 0x64, 0xA1, 0x57, 0xE3, 0x2F,
+        0x0E, 0x1F, 0x39, 0x58, 0x66, 0xC5, 0x47, 0x15,
+        0x6C, 0x4D, 0xF7, 0x31, 0xFF, 0xDD, 0x6A, 0x58,
+        0x01, 0x55, 0xCF, 0x8D, 0x3A, 0x1E, 0x6B, 0x1E
+    },
+    .points = {
+        {
+            0xD86D9D1D, 0x620D4A94, 0x28C0504B, 0x71904BA4, 0x01136077, 0x8688CD45, 0x7D00B2A7, 0xCF17AB3F,
+            0x3A1E6B1E, 0x0155CF8D, 0xFFDD6A58, 0x6C4DF731, 0x66C54715, 0x0E1F3958, 0xA157E32F, 0x77790F64
+        },
+        {
+            0xC8694B7B, 0x267C1DB1, 0xE86B100F, 0x98FEE780, 0xC4279F22, 0x665391AF, 0x1BE09617, 0xA9DE76CF,
+            0x7BEA7E41, 0x6DBB60BC, 0xA5AC234A, 0x61339BF4, 0x4AC80393, 0xEFAF17B1, 0xE40B3F2A, 0xC98E0298
+        },
+        {
+            0x1DBA9244, 0x5B78CCE3, 0x6D4D7B18, 0x1E9B61E5, 0xC9DCFB3D, 0xB745C222, 0x361407D8, 0xB30DEBEC,
+            0x566DC53F, 0x248D5BEF, 0x6B869E4B, 0xF87D1703, 0x0FBC3EE1, 0x4F2C6468, 0x16468E8E, 0x5369EC95
+        },
+        {
+            0x4E4C57D2, 0x61D89F17, 0x726B0C02, 0x8B7293EF, 0x38682D3E, 0x12F4E158, 0x8FB9B62E, 0xBA95EDBB,
+            0xC0DDE6EB, 0xC6F779CE, 0x163FD0FC, 0x80358896, 0x5F1F5F55, 0xCF999A62, 0x4952A492, 0x46B37331
+        },
+        {
+            0x6BD0FD4B, 0x22970946, 0xD7B9D97B, 0x4B97FCDD, 0x992D2650, 0x5207DFC5, 0xA44B75D9, 0xF9F18BC6,
+            0x82F4F71D, 0x9A78D4E0, 0xD9377437, 0x09174414, 0x78E9E3E4, 0x041960C8, 0x93FB4C27, 0xFD985FD6
+        },
+        {
+            0x6D4B612C, 0x43327426, 0x21494A46, 0xB20A8C6E, 0x328A6F5E, 0x8366603B, 0x2BB55AB2, 0xBF9F91B0,
+            0x49FC501F, 0xD643BD0E, 0x3872F5CD, 0xFEFEF334, 0xE9ECCD1D, 0xC0F0C2A0, 0xFA9D84F2, 0xF3B999E3
+        },
+        {
+            0x836C2120, 0x4B2F5DBE, 0xDF3EEC3C, 0xF1883886, 0x73FCDF7B, 0x42846DA4, 0x1174EB84, 0x571592F6,
+            0x96DAED56, 0x2FCCD6ED, 0xEA9F3D2B, 0x21E99353, 0xDE2E2945, 0x00E11A27, 0xE5C02CC5, 0x34D25867
+        },
+        {
+            0x27886F0D, 0x67C0072B, 0xE4B5CE5D, 0xA19D107B, 0x3ABAF3EC, 0xF091E9D9, 0xA0C39739, 0x2FFFDBE7,
+            0x1DFADFBB, 0x5D8009E4, 0xBC6765CB, 0x6A90BD36, 0x98D24406, 0x6BB9611F, 0x6E960AC1, 0x3474B3DA
+        },
+        {
+            0x1C3BFC62, 0xD6A9D785, 0xF3B55384, 0x80CB1C90, 0xCC3E0485, 0xD276DFC8, 0x466E6BD0, 0x0C678F62,
+            0x481D9770, 0x94159582, 0xA6CE8AF4, 0x5FBC28BE, 0x3AC3CA24, 0xC2E3AEE4, 0x6A617CF7, 0x3468C0D6
+        },
+        {
+            0x5FBFEED3, 0xC7314DA6, 0x31948F57, 0xF370199A, 0xFFB2AA52, 0xE04B3650, 0xDEA865DC, 0x08B81FA2,
+            0xC9C2AA16, 0x40CA4F51, 0xAEB0233A, 0xA6CF6F43, 0x11DD5C46, 0xC780BA8E, 0x4EB78ACA, 0x90985204
+        },
+        {
+            0x62B11594, 0xD4D880BD, 0xE69EB671, 0xE28BE7F3, 0x70A18DD6, 0x128892C5, 0xA1033A81, 0x5F3C3DC3,
+            0x7269AAF1, 0xBC488D7D, 0x4264764A, 0x9694D996, 0x0158B4F2, 0xB8AEBD15, 0x2EB97E68, 0x55311763
+        },
+        {
+            0x2A512644, 0xDCE35A3E, 0x7C6879AA, 0x5E5FAC43, 0xD2BC7F31, 0xD6AFB4C1, 0x3A0EF2FA, 0xD8530A24,
+            0x1831D310, 0xBE541D87, 0x00B93006, 0x597EF67F, 0x34B6B522, 0x3132BBCA, 0x7290570C, 0x206B7BD2
+        },
+        {
+            0xFBA3267C, 0x2F99F1D5, 0xFE846D0D, 0x66301400, 0xA6D95618, 0x87360B62, 0x098EC17E, 0xA3013A5B,
+            0x2C259FC9, 0x6812CE88, 0xDB637486, 0x1A831731, 0xFD90BC64, 0x1AFD9C56, 0x11B62EB1, 0x288C6FAC
+        },
+        {
+            0xE7811111, 0x3FBE4372, 0x331357F2, 0x32106A46, 0x9ABF3277, 0xF2591047, 0x97E0C556, 0x1E06FE9B,
+            0x5C147A64, 0x1C992985, 0x430D1D44, 0xAE495A6F, 0xB23EEA15, 0x31C7ED27, 0x26A9408C, 0x90173DDD
+        },
+        {
+            0xC8A796DF, 0x3C5A593B, 0x3701FD7D, 0x50095B0C, 0xB80BB85A, 0xA3964C14, 0x79A2AF6F, 0xB127EDB3,
+            0x97348444, 0x3E927021, 0xF67E07F2, 0xE3B47A72, 0x0E85F84E, 0x064CF2F2, 0xF6B68367, 0x92E8C346
+        },
+        {
+            0x7E9DE5AC, 0xB50ED407, 0xB3D186B2, 0x4E564EE6, 0xD2F2701E, 0x7CE9FF6D, 0xD05FB0FB, 0xC664BD93,
+            0x9693C3AD, 0x7D713EE1, 0x7031E0E1, 0xAD4C5A05, 0x7D341170, 0x6A913725, 0xAC993554, 0xFDBEF7F9
+        },
+        {
+            0x16F432E6, 0x081F58CA, 0x84CB541B, 0x97A328CF, 0x22C92CC0, 0x57FFAE7B, 0x00FAE103, 0x12C71DBA,
+            0xBA2872E8, 0xED27DC1A, 0x7014968E, 0x5FBB7626, 0xBEF2DB82, 0xCAF70929, 0x881610EF, 0x53495F4C
+        },
+        {
+            0x28F6C453, 0xCCAEE49C, 0x84B0382E, 0xCCE70692, 0xB3B22F54, 0x697E2737, 0x1B64DB3D, 0xE69D336F,
+            0xCFA0B1B9, 0x3848F0AD, 0x2FD331EF, 0x65010304, 0xD2155DD9, 0xE2E61B55, 0x94B94860, 0xFE0A9EEC
+        },
+        {
+            0xAFF36D66, 0xBACC1508, 0x96644547, 0x5CDDF7F3, 0x3017DFA0, 0x749528AA, 0xB01E530D, 0x9DBF2698,
+            0x366A70F5, 0x42B15C30, 0x0E6CC8CF, 0xDDB3AF99, 0x65839643, 0xDCC30A13, 0x9F2169A3, 0x69AD6ECF
+        },
+        {
+            0x5C158946, 0x97982545, 0x3C43B833, 0x325B374F, 0x7E578C49, 0x4604774A, 0x5B25FB5F, 0xC98E5763,
+            0x19AB42EF, 0x1508E8F3, 0xD3F12FB1, 0xBFA3BDD5, 0x2B2CA3AE, 0x739DE800, 0x7D85FEB4, 0xB4FA35B3
+        },
+        {
+            0x6B02AEC9, 0xC1665D13, 0x2B7CCBC9, 0x27BBE6A8, 0xD60535E4, 0x67AAC6B1, 0x73C42CC6, 0x92FE6BEA,
+            0x16D38841, 0x05B80FA0, 0xA6140C61, 0x334044D8, 0x29099E20, 0x79F423C0, 0x07DBC488, 0xBE8A94CD
+        },
+        {
+            0x1952A3F5, 0x5F8C5DCA, 0xCC73B50F, 0x5AEC23FD, 0x32E43C08, 0xCF15F21C, 0xFB498824, 0x6F7F44C2,
+            0xA0CCA6E9, 0xC81BDC55, 0xA1BCF008, 0x649439D6, 0xBD769E02, 0x6EA33218, 0x90C61EA2, 0x3C95F5EA
+        },
+        {
+            0x23548994, 0x51594B6A, 0x21120D58, 0xD4E726F4, 0xE7D20828, 0x1CCD9CCD, 0x3248B7C4, 0x12A4C174,
+            0x08551F8C, 0x2AC5F3B4, 0x3E135559, 0x36FD5C65, 0x0E5D6773, 0xD8FC3537, 0x65F21CCC, 0x2EEE5E4E
+        },
+        {
+            0x644ABC3F, 0xDCBF1FBA, 0x5009F220, 0x65A71DD4, 0x253CE7B4, 0xD8D756B1, 0xF3800837, 0x5027EF02,
+            0xAA76C5A0, 0xB8CA5C0D, 0x8EDB40C2, 0x69E97F3C, 0x2757FEED, 0x6505AABD, 0x8ABDB839, 0xF8BDCD9D
+        },
+        {
+            0x9B575C30, 0x09DCF47D, 0x1DDAA54E, 0x0FA239D0, 0xC7B45F31, 0x2D11AF47, 0x3B2D643E, 0x7D39F046,
+            0x75C4A66E, 0x254FC709, 0xF6CBF4CA, 0x93B8949A, 0xE50E6E74, 0x32115A1E, 0xDE4F4277, 0x1308EC99
+        },
+        {
+            0x9A1DCA8D, 0x98001A51, 0xB10EF6B1, 0x7EF7C313, 0x92312A2C, 0xDBCBA679, 0x795FB8C8, 0x21EB5F3D,
+            0xC1F9BE8E, 0x95B11DC5, 0x602C6939, 0x3BEDE353, 0x38FAF192, 0xACA93730, 0xC8CA593F, 0xCABD6819
+        },
+        {
+            0x50E1866B, 0x333B5CB3, 0xEE5A703C, 0xCC615CA5, 0x88A0F2F7, 0x26D2E6A7, 0x9B0449AD, 0x4FCC1875,
+            0x5A023656, 0x75C5FF2E, 0xFA0BC5B1, 0xD8C9215F, 0x36362BC9, 0x7D4E4B0D, 0x4655010B, 0x37BBEC61
+        },
+        {
+            0x4C861975, 0xC27CA622, 0xF9B3D4E4, 0x5669AB76, 0x5135806C, 0x2E8BF75F, 0x69562CA9, 0xE7F4B776,
+            0xF33AD5B1, 0x74C4AE5D, 0xB2F80865, 0x71E8DC8C, 0xDC7822DC, 0x8FB00DCC, 0xE9DBF987, 0x21783529
+        },
+        {
+            0x85FA32D6, 0x2C524C87, 0xD0534CC7, 0xE422CC63, 0xA08C743A, 0x56F72B89, 0x98C4B7AF, 0xD7D4E488,
+            0xA54232B6, 0x0386EC37, 0xBBD8B3BB, 0x77C14C7C, 0x0E7B59AD, 0x523F0116, 0x9F0AFA2B, 0x16CB5DC4
+        },
+        {
+            0x0CFF3F0B, 0x01AFDD1A, 0x63F8405A, 0xAA5111D0, 0x68E8DCE9, 0x1EBC9086, 0xD9DA2119, 0xBF49391F,
+            0x8B3DC360, 0xEF571DD8, 0xC9860F79, 0x67F3E461, 0x873CA2C7, 0x2D80363E, 0x826578C7, 0x6B508D95
+        },
+        {
+            0x39BE8951, 0xED4BD979, 0xA09D435E, 0xAA8C512E, 0x6C8423ED, 0x62CF22DE, 0x940B3740, 0xAC7283A5,
+            0xA6477F6C, 0x6150A7D6, 0x114E6E80, 0x43FD16EB, 0xE344D75D, 0x78049AC2, 0x0A3F41D9, 0x0B4E6C57
+        },
+    }
+};
+
+/* AES Secret Key (from secret.key) */
+const uint8_t AES_SECRET_KEY[16] = {
+    0xCE, 0x9E, 0x75, 0x44, 0xA2, 0x50, 0xA0, 0x45,
+    0x6E, 0xD0, 0x5E, 0x2F, 0x2C, 0x25, 0x05, 0x76
+};
@@ -0,0 +1,59 @@
+"""Test (user-005): packages built before fw_header_t still install.
+
+A headerless package has no footer offset, so the bootloader finds its
+footer by scanning S6 backwards (Find_Footer_Address). Installs one on
+an update request and on the button, rolls it back, and rejects one
+whose ciphertext or signature was damaged, on the fused and the separate
+verify builds.
+"""
+
+import argparse
+
+from sim import S5, S6, EXIT_APP, STATE_ROLLBACK, STATE_UPDATE_REQ, Checks, Sim, make_app
+
+
+def install(sim, bootloader, old, package, button=False):
+    sim.erase_all()
+    sim.write(S5, old)
+    sim.write(S6, package)
+    if not button:
+        sim.set_state(STATE_UPDATE_REQ)
+    return sim.run(button=button, bootloader=bootloader)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--fused", required=True, help="bootloader_posix with BL_FUSED_VERIFY=1")
+    parser.add_argument("--separate", required=True, help="bootloader_posix with BL_FUSED_VERIFY=0")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(30 * 1024, seed=1)
+    new = make_app(45 * 1024 + 5, seed=2)
+
+    with Sim(args.fused) as sim:
+        package = sim.package_legacy(new)
+        t.check(package[:4] != b"HDR!", "package has no header")
+
+        for build, bootloader in (("fused", args.fused), ("separate", args.separate)):
+            for how, button in (("update request", False), ("button", True)):
+                name = f"{build}, {how}"
+                result = install(sim, bootloader, old, package, button=button)
+                t.check(result.rc == EXIT_APP and sim.holds(S5, new), f"{name}: installs")
+
+            sim.set_state(STATE_ROLLBACK)
+            result = sim.run(bootloader=bootloader)
+            t.check(result.rc == EXIT_APP and sim.holds(S5, old), f"{build}: rolls back")
+
+            for what, offset in (("ciphertext", 100), ("signature", len(package) - 60)):
+                bad = bytearray(package)
+                bad[offset] ^= 1
+                result = install(sim, bootloader, old, bytes(bad))
+                t.check(result.rc == EXIT_APP and sim.holds(S5, old),
+                        f"{build}, damaged {what}: rejected, old image kept")
+                t.check("Error Code" in result.out, f"{build}, damaged {what}: reported")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
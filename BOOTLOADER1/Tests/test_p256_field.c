@@ -0,0 +1,132 @@
+/*
+ * test_p256_field.c
+ *
+ * The unrolled field kernels of BL_P256_UNROLLED=1 (p256_field.c) against
+ * TinyCrypt's generic arithmetic used with BL_P256_UNROLLED=0, on random
+ * and edge-case operands and on any 512-bit product for the reduction.
+ * Prints the cycles per multiply of both and checks that the kernels
+ * are faster.
+ */
+
+#include <string.h>
+
+#include "test_util.h"
+#include "p256_field.h"
+#include "ecc.h"
+
+#define RANDOM_VECTORS  20000U
+#define BENCH_RUNS      20000U
+
+static uint32_t seed = 23;
+static const uint32_t *p;
+
+/* A random field element, below p */
+static void Random_Fe(uint32_t a[8]) {
+    Test_Fill(&seed, (uint8_t *)a, 32);
+    if (uECC_vli_cmp_unsafe(p, a, 8) != 1)
+        uECC_vli_sub(a, a, p, 8);
+}
+
+/* 512-bit product, schoolbook (TinyCrypt keeps its own static) */
+static void Mult(uint32_t product[16], const uint32_t a[8], const uint32_t b[8]) {
+    memset(product, 0, 64);
+    for (int i = 0; i < 8; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < 8; j++) {
+            carry += (uint64_t)a[i] * b[j] + product[i + j];
+            product[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        product[i + 8] = (uint32_t)carry;
+    }
+}
+
+static void Check_Pair(const uint32_t a[8], const uint32_t b[8]) {
+    uint32_t fast[8], ref[8], product[16];
+
+    P256_Mul(fast, a, b);
+    uECC_vli_modMult_fast(ref, a, b, uECC_secp256r1());
+    CHECK(memcmp(fast, ref, 32) == 0);
+
+    P256_Sqr(fast, a);
+    uECC_vli_modMult_fast(ref, a, a, uECC_secp256r1());
+    CHECK(memcmp(fast, ref, 32) == 0);
+
+    /* Aliased operands, as the point formulas use them */
+    memcpy(fast, a, 32);
+    P256_Mul(fast, fast, b);
+    uECC_vli_modMult_fast(ref, a, b, uECC_secp256r1());
+    CHECK(memcmp(fast, ref, 32) == 0);
+
+    Mult(product, a, b);
+    P256_Reduce(fast, product);
+    CHECK(memcmp(fast, ref, 32) == 0);
+}
+
+static void Test_Edges(void) {
+    uint32_t edges[6][8] = { { 0 }, { 1 } };
+
+    memcpy(edges[2], p, 32);
+    edges[2][0] -= 1;                                   /* p - 1 */
+    memcpy(edges[3], p, 32);
+    edges[3][0] -= 2;                                   /* p - 2 */
+    memset(edges[4], 0xFF, 28);                         /* 2^224 - 1 */
+    edges[5][7] = 0x80000000U;                          /* 2^255 */
+
+    for (int i = 0; i < 6; i++)
+        for (int j = 0; j < 6; j++)
+            Check_Pair(edges[i], edges[j]);
+}
+
+/* P256_Reduce takes any 512-bit value, not just products of reduced elements */
+static void Test_Reduce(void) {
+    uint32_t product[16], copy[16], fast[8], ref[8];
+
+    for (uint32_t i = 0; i < RANDOM_VECTORS; i++) {
+        if (i == 0)
+            memset(product, 0xFF, sizeof(product));
+        else
+            Test_Fill(&seed, (uint8_t *)product, sizeof(product));
+        memcpy(copy, product, sizeof(product));
+        P256_Reduce(fast, product);
+        uECC_vli_mmod(ref, copy, p, 8);
+        CHECK(memcmp(fast, ref, 32) == 0);
+    }
+}
+
+static void Bench(void) {
+    uint32_t a[8], b[8];
+    uint64_t fast, ref;
+
+    Random_Fe(a);
+    Random_Fe(b);
+
+    uint64_t t = Test_Cycles();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        P256_Mul(a, a, b);
+    fast = Test_Cycles() - t;
+
+    t = Test_Cycles();
+    for (uint32_t r = 0; r < BENCH_RUNS; r++)
+        uECC_vli_modMult_fast(a, a, b, uECC_secp256r1());
+    ref = Test_Cycles() - t;
+
+    printf("Field multiply: unrolled %.0f cycles, TinyCrypt %.0f cycles (%.1fx)\n",
+           (double)fast / BENCH_RUNS, (double)ref / BENCH_RUNS, (double)ref / (double)fast);
+    CHECK(fast < ref);
+}
+
+int main(void) {
+    uint32_t a[8], b[8];
+
+    p = uECC_secp256r1()->p;
+    Test_Edges();
+    for (uint32_t i = 0; i < RANDOM_VECTORS; i++) {
+        Random_Fe(a);
+        Random_Fe(b);
+        Check_Pair(a, b);
+    }
+    Test_Reduce();
+    Bench();
+    return TEST_EXIT();
+}
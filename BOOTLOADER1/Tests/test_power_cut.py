@@ -0,0 +1,128 @@
+"""Test (user-008): cut power during every flash operation of an install and a rollback.
+
+For each operation N, the run before it is replayed from the same flash
+image with BL_SIM_CUT_AT=N, then the bootloader boots again with power
+kept. It must never halt or loop, and must end on the intended image:
+straight away, or after the request is made again when the cut came
+before the swap was recorded (for an install, with the package sent to
+S6 again if it was erased). The install is also swept with the config
+log running out at each of its records, so cuts hit the erase of the
+other log sector at every step of the swap.
+
+AES-CTR packages (user-014), and overwrite installs (user-025), are swept
+too, with the update staged in S7 as well as in RAM, so cuts land inside
+the decryption of the ciphertext, where the resumed install has to take
+up the counter again from the start of the unit.
+"""
+
+import argparse
+
+from sim import (S5, S6, CONFIG_SLOT_SIZE, EXIT_APP, EXIT_CUT, RECORD_SIZE, STATE_NORMAL,
+                 STATE_ROLLBACK, STATE_UPDATE_REQ, Checks, Sim, make_app)
+
+
+# Cases: package options, simulator environment
+CASES = [
+    ([], {}),
+    ([], {"BL_SIM_RAM_STAGE_SIZE": 0}),
+    (["--lz4"], {}),
+    (["--aead"], {}),
+    (["--overwrite"], {}),
+    (["--ctr"], {}),
+    (["--ctr"], {"BL_SIM_RAM_STAGE_SIZE": 0}),
+    (["--ctr", "--overwrite"], {}),
+]
+
+
+def in_decrypt(out):
+    """True if the run was cut while programming decrypted data."""
+    lines = out.strip().splitlines()
+    steps = [line for line in lines if line.startswith("[") and "/3]" in line]
+    decrypting = steps and ("Decrypting" in steps[-1] or "(no backup)" in steps[-1])
+    return bool(decrypting) and lines[-1].endswith("Erasing Target Area... OK")
+
+
+def sweep(t, sim, name, start, target, request, env):
+    """Cuts each flash operation after start; returns (operations, repeated requests, cuts in decryption)."""
+    repeats = 0
+    decrypt_cuts = 0
+    n = 0
+    while True:
+        n += 1
+        sim.restore(start)
+        cut = sim.run(BL_SIM_CUT_AT=n, **env)
+        if cut.rc != EXIT_CUT:
+            t.check(cut.rc == EXIT_APP and sim.holds(S5, target), f"{name}: uncut run ({cut})")
+            return n - 1, repeats, decrypt_cuts
+        decrypt_cuts += in_decrypt(cut.out)
+
+        result = sim.run(**env)
+        if result.rc == EXIT_APP and not sim.holds(S5, target):
+            request()
+            result = sim.run(**env)
+            repeats += 1
+        t.check(result.rc == EXIT_APP and sim.holds(S5, target),
+                f"{name}: cut at operation {n} recovers (rc={result.rc})")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True, help="bootloader_posix")
+    args = parser.parse_args()
+    t = Checks()
+
+    old = make_app(12 * 1024, seed=1)
+    new = make_app(20 * 1024, seed=2, compressible=True)
+
+    with Sim(args.bootloader) as sim:
+        for opts, env in CASES:
+            package = sim.package(new, *opts)
+
+            def request_update():
+                if not sim.holds(S6, package):
+                    sim.erase(S6, len(package))
+                    sim.write(S6, package)
+                sim.set_state(STATE_UPDATE_REQ)
+
+            sim.erase_all()
+            sim.write(S5, old)
+            sim.write(S6, package)
+            sim.set_state(STATE_UPDATE_REQ)
+            label = " ".join(opts) or "AES-CBC"
+            if env:
+                label += ", S7 staging"
+            name = f"install {label}"
+            ops, repeats, decrypt_cuts = sweep(t, sim, name, sim.save(), new, request_update, env)
+            print(f"{name:<36} {ops:>4} flash operations cut, {repeats} needed the request again, "
+                  f"{decrypt_cuts} inside the decryption")
+            if "--ctr" in opts and (env or "--overwrite" in opts):
+                t.check(decrypt_cuts > 1, f"{name}: cuts land inside the ciphertext")
+
+            if opts == [] and not env:
+                # The log runs out at each config write of the install, in
+                # sector 1, and once in sector 2 (back to sector 1)
+                slots = CONFIG_SLOT_SIZE // RECORD_SIZE
+                for records in [slots - free for free in range(1, 6)] + [2 * slots - 3]:
+                    sim.erase_all()
+                    sim.write(S5, old)
+                    sim.write(S6, package)
+                    for _ in range(records):
+                        sim.set_state(STATE_NORMAL)
+                    sim.set_state(STATE_UPDATE_REQ)
+                    name = f"install, {records + 1} records"
+                    ops, repeats, _ = sweep(t, sim, name, sim.save(), new, request_update, env)
+                    print(f"{name:<36} {ops:>4} flash operations cut, {repeats} needed the request again")
+
+            if "--overwrite" in opts:
+                continue
+            sim.run(**env)
+            sim.set_state(STATE_ROLLBACK)
+            name = f"rollback {label}"
+            ops, repeats, _ = sweep(t, sim, name, sim.save(), old,
+                                    lambda: sim.set_state(STATE_ROLLBACK), env)
+            print(f"{name:<36} {ops:>4} flash operations cut, {repeats} needed the request again")
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+"""Test (user-022): toggling between two images only erases S5.
+
+Installs an update, then rolls back and forth. Once S7 holds a copy of
+S5 (left by an update staged in S7, or by a full rollback after a RAM
+staged one), every rollback must put the other image in S5 with one
+erase of S5 and none of S6 or S7, and leave S6 and S7 as they were but
+for the mirror trailer at the end of S7. Each toggle is then swept with
+power cut at every flash operation: the run after the cut, with the
+rollback requested again if it had not been recorded, must end on the
+intended image, and the next rollback must still bring back the other.
+"""
+
+import argparse
+
+from sim import S5, S6, S7, SLOT_SIZE, EXIT_APP, EXIT_CUT, STATE_ROLLBACK, STATE_UPDATE_REQ, \
+    Checks, Sim, make_app
+
+MIRROR_TRAILER = 48  # fw_mirror_trailer_t
+
+
+def holding(sim, images):
+    for name, image in images.items():
+        if sim.holds(S5, image):
+            return name
+    return "neither"
+
+
+def toggle(t, sim, images, env, name):
+    """One rollback from the current state; returns the image it should leave in S5."""
+    target = "old" if holding(sim, images) == "new" else "new"
+    s6 = sim.read(S6, SLOT_SIZE)
+    s7 = sim.read(S7, SLOT_SIZE - MIRROR_TRAILER)
+
+    sim.set_state(STATE_ROLLBACK)
+    result = sim.run(**env)
+    t.check(result.rc == EXIT_APP and holding(sim, images) == target,
+            f"{name}: S5 holds the {target} image ({result})")
+    t.check(result.slot_erases == {"S5": 1, "S6": 0, "S7": 0},
+            f"{name}: only S5 erased ({result.slot_erases})")
+    t.check(sim.read(S6, SLOT_SIZE) == s6, f"{name}: S6 unchanged")
+    t.check(sim.read(S7, SLOT_SIZE - MIRROR_TRAILER) == s7, f"{name}: S7 unchanged")
+    return target
+
+
+def sweep(t, sim, images, env, name):
+    """Cuts each flash operation of the next toggle; returns the number cut."""
+    start = sim.save()
+    target = "old" if holding(sim, images) == "new" else "new"
+    other = "new" if target == "old" else "old"
+    n = 0
+    while True:
+        n += 1
+        sim.restore(start)
+        sim.set_state(STATE_ROLLBACK)
+        cut = sim.run(BL_SIM_CUT_AT=n, **env)
+        if cut.rc != EXIT_CUT:
+            sim.restore(start)
+            return n - 1
+
+        result = sim.run(**env)
+        if result.rc == EXIT_APP and holding(sim, images) != target:
+            sim.set_state(STATE_ROLLBACK)
+            result = sim.run(**env)
+        t.check(result.rc == EXIT_APP and holding(sim, images) == target,
+                f"{name}: cut at operation {n} recovers")
+
+        sim.set_state(STATE_ROLLBACK)
+        result = sim.run(**env)
+        t.check(result.rc == EXIT_APP and holding(sim, images) == other,
+                f"{name}: cut at operation {n}, next rollback brings back the {other} image")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True, help="bootloader_posix")
+    args = parser.parse_args()
+    t = Checks()
+
+    images = {"old": make_app(12 * 1024, seed=1), "new": make_app(20 * 1024 + 5, seed=2)}
+
+    with Sim(args.bootloader) as sim:
+        for staging, env in (("S7", {"BL_SIM_RAM_STAGE_SIZE": 0}), ("RAM", {})):
+            sim.erase_all()
+            sim.write(S5, images["old"])
+            sim.write(S6, sim.package(images["new"]))
+            sim.set_state(STATE_UPDATE_REQ)
+            result = sim.run(**env)
+            t.check(result.rc == EXIT_APP and holding(sim, images) == "new",
+                    f"{staging} staging: update installs")
+
+            if staging == "RAM":
+                # S7 was not written: the first rollback is the full swap, which leaves the copy
+                sim.set_state(STATE_ROLLBACK)
+                result = sim.run(**env)
+                t.check(result.rc == EXIT_APP and holding(sim, images) == "old",
+                        f"{staging} staging: full rollback")
+                t.check(result.slot_erases == {"S5": 1, "S6": 1, "S7": 1},
+                        f"{staging} staging: full rollback erases all three slots")
+
+            for i in range(1, 5):
+                name = f"{staging} staging, toggle {i}"
+                ops = sweep(t, sim, images, env, name)
+                t.check(ops >= 3, f"{name}: {ops} flash operations cut")
+                print(f"{name:<24} {ops:>3} flash operations cut")
+                toggle(t, sim, images, env, name)
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,68 @@
+/*
+ * test_util.h
+ *
+ * Minimal check macros for the host tests. A failed CHECK prints the
+ * location and is counted; TEST_EXIT() turns the count into the exit
+ * status that ctest reads.
+ */
+
+#ifndef TESTS_TEST_UTIL_H_
+#define TESTS_TEST_UTIL_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_EXIT()  (test_failures ? (fprintf(stderr, "%d check(s) failed\n", test_failures), 1) : 0)
+
+/* Host time for the benchmarks, in ns */
+static inline uint64_t Test_Now_Ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+/* CPU cycles for the per-byte figures: the time-stamp counter on x86,
+ * ns elsewhere */
+static inline uint64_t Test_Cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return Test_Now_Ns();
+#endif
+}
+
+/* Deterministic test data (xorshift32) */
+static inline uint32_t Test_Rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static inline void Test_Fill(uint32_t *state, uint8_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++)
+        buf[i] = (uint8_t)Test_Rand(state);
+}
+
+/* Test vectors: hex string to bytes */
+static inline uint8_t Test_Nibble(char c) {
+    return (uint8_t)((c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10);
+}
+
+static inline void Test_Hex(uint8_t *out, const char *hex) {
+    for (; hex[0] && hex[1]; hex += 2)
+        *out++ = (uint8_t)(Test_Nibble(hex[0]) << 4 | Test_Nibble(hex[1]));
+}
+
+#endif /* TESTS_TEST_UTIL_H_ */
@@ -0,0 +1,102 @@
+"""Slot selection of a BL_XIP_AB bootloader (user-024).
+
+Signs an image for each slot at a chosen version and checks which slot
+is started: with no slot recorded, on an update request with a newer,
+older or invalid image in the other slot, on a rollback (state or
+button), after the selected slot was erased, and with no valid image.
+An image whose footer version was raised after signing must be rejected.
+"""
+
+import argparse
+import re
+
+from sim import S5, S6, EXIT_APP, EXIT_HALT, STATE_NORMAL, STATE_ROLLBACK, \
+    STATE_UPDATE_REQ, Checks, Sim, make_app
+
+RUNNING = re.compile(r"Running in place from 0x([0-9A-F]+) \(version 0x([0-9A-F]+)\)")
+
+
+def started(result):
+    """(slot, version) the bootloader jumped to, or None."""
+    m = RUNNING.search(result.out)
+    if result.rc != EXIT_APP or not m:
+        return None
+    return int(m.group(1), 16), int(m.group(2), 16)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--bootloader", required=True,
+                        help="bootloader_posix on the test keys, built with BL_XIP_AB=1")
+    args = parser.parse_args()
+    t = Checks()
+
+    with Sim(args.bootloader) as sim:
+        def image(slot, version, seed):
+            return sim.package(make_app(20 * 1024, seed=seed, slot=slot), "--xip", hex(slot),
+                               version=version)
+
+        s5_v1, s5_v3 = image(S5, 0x100, 1), image(S5, 0x300, 2)
+        s6_v2, s6_v0 = image(S6, 0x200, 3), image(S6, 0x080, 4)
+
+        # Footer version raised after signing
+        forged = bytearray(s6_v0)
+        forged[-76:-72] = (0x900).to_bytes(4, "little")
+        forged = bytes(forged)
+
+        def boot(s5, s6, status=STATE_NORMAL, running=None, button=False):
+            """Lays out the slots and boots; running is (slot, version) as recorded."""
+            sim.erase_all()
+            if s5:
+                sim.write(S5, s5)
+            if s6:
+                sim.write(S6, s6)
+            slot, version = running or (None, 0)
+            sim.set_state(status, version, slot=slot)
+            return started(sim.run(button=button))
+
+        # No slot recorded: the newer valid image runs
+        t.check(boot(s5_v1, s6_v2) == (S6, 0x200), "no slot: newer S6")
+        t.check(boot(s5_v3, s6_v2) == (S5, 0x300), "no slot: newer S5")
+        t.check(boot(s5_v1, s6_v0) == (S5, 0x100), "no slot: older S6")
+        t.check(boot(s5_v1, forged) == (S5, 0x100), "no slot: forged S6 version")
+        t.check(boot(None, s6_v0) == (S6, 0x080), "no slot: only S6")
+
+        # The choice is recorded: a normal boot keeps it without checking the other slot
+        boot(s5_v1, s6_v2)
+        sim.write(S5, s5_v3)
+        t.check(started(sim.run()) == (S6, 0x200), "recorded slot kept")
+
+        on_s5, on_s6 = (S5, 0x100), (S6, 0x200)
+
+        # Update request from S5
+        t.check(boot(s5_v1, s6_v2, STATE_UPDATE_REQ, on_s5) == on_s6, "update: newer S6")
+        t.check(boot(s5_v1, s6_v0, STATE_UPDATE_REQ, on_s5) == on_s5, "update: older S6 kept S5")
+        t.check(boot(s5_v1, forged, STATE_UPDATE_REQ, on_s5) == on_s5, "update: forged S6 version")
+        bad = bytearray(s6_v2)
+        bad[100] ^= 1
+        t.check(boot(s5_v1, bytes(bad), STATE_UPDATE_REQ, on_s5) == on_s5, "update: corrupt S6")
+        t.check(boot(s5_v1, None, STATE_UPDATE_REQ, on_s5) == on_s5, "update: erased S6")
+        # An image linked for S5 does not run from S6
+        t.check(boot(s5_v1, s5_v3, STATE_UPDATE_REQ, on_s5) == on_s5, "update: S6 linked for S5")
+
+        # Rollback to any valid image, older or not
+        t.check(boot(s5_v1, s6_v2, STATE_ROLLBACK, on_s6) == on_s5, "rollback: older S5")
+        t.check(boot(s5_v1, s6_v2, running=on_s6, button=True) == on_s5, "rollback: button")
+        t.check(boot(None, s6_v2, STATE_ROLLBACK, on_s6) == on_s6, "rollback: no image kept S6")
+        t.check(started(sim.run()) == on_s6, "rollback: next boot stays in S6")
+
+        # The selected slot was erased: fall back to the valid one
+        t.check(boot(s5_v1, None, running=on_s6) == on_s5, "erased selected slot")
+        t.check(boot(None, s6_v2, running=on_s5) == on_s6, "erased selected slot S5")
+
+        # Nothing valid: halt
+        sim.erase_all()
+        sim.write(S6, forged)
+        t.check(sim.run().rc == EXIT_HALT, "no valid image: halt")
+
+    t.exit()
+
+
+if __name__ == "__main__":
+    main()
@@ -1,7 +1,19 @@
+import sys
+
 from cryptography.hazmat.primitives import serialization
 from cryptography.hazmat.backends import default_backend
 
 
+# P-256 domain parameters (FIPS 186-4, D.1.2.3)
+P256_P = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+P256_GX = 0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296
+P256_GY = 0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5
+
+# Comb width: must match ECDSA_COMB_TEETH in Core/Inc/ecdsa_comb.h
+COMB_TEETH = 5
+COMB_ROWS = (256 + COMB_TEETH - 1) // COMB_TEETH
+
+
 def fmt_bytes(data, indent='    ', cols=8):
     """Format bytes as C hex literals, `cols` per row."""
     rows = []
@@ -11,6 +23,78 @@ def fmt_bytes(data, indent='    ', cols=8):
     return ',\n'.join(rows)
 
 
+def point_add(a, b):
+    """Affine P-256 addition; None is the point at infinity."""
+    if a is None:
+        return b
+    if b is None:
+        return a
+    (x1, y1), (x2, y2) = a, b
+    if x1 == x2:
+        if (y1 + y2) % P256_P == 0:
+            return None
+        lam = (3 * x1 * x1 - 3) * pow(2 * y1, -1, P256_P)    # a = -3
+    else:
+        lam = (y2 - y1) * pow(x2 - x1, -1, P256_P)
+    lam %= P256_P
+    x3 = (lam * lam - x1 - x2) % P256_P
+    return x3, (lam * (x1 - x3) - y1) % P256_P
+
+
+def point_mul_pow2(point, e):
+    """2^e * point."""
+    for _ in range(e):
+        point = point_add(point, point)
+    return point
+
+
+def comb_table(point):
+    """points[j - 1] = sum of 2^(i * COMB_ROWS) * point over the bits i of j."""
+    teeth = [point]
+    for _ in range(1, COMB_TEETH):
+        teeth.append(point_mul_pow2(teeth[-1], COMB_ROWS))
+
+    table = []
+    for j in range(1, 1 << COMB_TEETH):
+        acc = None
+        for i in range(COMB_TEETH):
+            if j & (1 << i):
+                acc = point_add(acc, teeth[i])
+        table.append(acc)
+    return table
+
+
+def le_words(value):
+    """256-bit integer as 8 little-endian 32-bit words (TinyCrypt native order)."""
+    return [(value >> (32 * i)) & 0xFFFFFFFF for i in range(8)]
+
+
+def print_comb_table(name, x, y, comment):
+    """Print an ECDSA_CombTable_t initializer for the point (x, y)."""
+    xy = x.to_bytes(32, byteorder='big') + y.to_bytes(32, byteorder='big')
+    print(f"/* {comment} */")
+    print(f"const ECDSA_CombTable_t {name} = {{")
+    print("    .public_key = {")
+    print(fmt_bytes(xy, indent='        '))
+    print("    },")
+    print("    .points = {")
+    for px, py in comb_table((x, y)):
+        words = le_words(px) + le_words(py)
+        print("        {")
+        for i in range(0, 16, 8):
+            sep = ',' if i == 0 else ''
+            print("            " + ', '.join(f'0x{w:08X}' for w in words[i:i + 8]) + sep)
+        print("        },")
+    print("    }")
+    print("};")
+
+
+# --- G table: regenerates Core/Src/Drivers/ecdsa_comb_g.c ---
+if '--g-table' in sys.argv[1:]:
+    print_comb_table("ECDSA_G_comb", P256_GX, P256_GY,
+                     f"P-256 base point, {COMB_TEETH}-teeth comb (extract_pubkey.py --g-table)")
+    sys.exit(0)
+
 # --- 1. Extract ECDSA Public Key (X || Y concatenated) ---
 try:
     with open("public.pem", "rb") as f:
@@ -30,6 +114,11 @@ try:
     print(fmt_bytes(y))
     print("};")
 
+    # Comb table for the same key, ECDSA_public_key_comb in keys.c
+    print()
+    print_comb_table("ECDSA_public_key_comb", numbers.x, numbers.y,
+                     "Public key comb table (from public.pem)")
+
 except FileNotFoundError:
     print("Error: 'public.pem' not found. Run keygen.py first.")
 
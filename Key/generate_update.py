@@ -1,20 +1,138 @@
-import sys
+import argparse
 import struct
 import os
 import hashlib
-from Crypto.Cipher import AES
+from Crypto.Cipher import AES, ChaCha20, ChaCha20_Poly1305
 from Crypto.Util.Padding import pad
 from ecdsa import SigningKey
 
 # --- Configuration ---
 FOOTER_MAGIC = 0x454E4421  # "END!"
+HEADER_MAGIC = 0x48445221  # "HDR!"
+HEADER_SIZE = 16
+FLAG_LZ4 = 1 << 0
+FLAG_CHACHA20 = 1 << 1
+FLAG_AES_CTR = 1 << 2
+FLAG_AEAD = 1 << 3
+FLAG_CHUNKED = 1 << 4
+FLAG_OVERWRITE = 1 << 5
+AEAD_TAG_SIZE = 16         # must match FW_AEAD_TAG_SIZE
+AEAD_DIGEST_SIZE = 32      # must match FW_AEAD_DIGEST_SIZE
+CHUNK_SIZE = 4096          # must match FW_CHUNK_SIZE
+CHACHA20_KEY_LABEL = b"BL ChaCha20 key"  # must match FW_CHACHA20_KEY_LABEL
+LZ4_BLOCK_SIZE = 4096      # must match FW_LZ4_BLOCK_SIZE
+LZ4_HISTORY = 64 * 1024    # LZ4 maximum match distance
 FIRMWARE_VERSION = 0x0100  # 1.0.0
 
 KEY_FILE = "private.pem"
 AES_KEY_FILE = "secret.key"
 OUTPUT_FILE = "update_encrypted.bin"
+XIP_OUTPUT_FILE = "update_xip_{:08X}.bin"
+SLOT_SIZE = 0x40000        # must match SLOT_SIZE in mem_layout.h
 
-def generate_update(input_file):
+def lz4_compress(fw_data):
+    """Compress into [u32 len][LZ4 block] records of LZ4_BLOCK_SIZE plaintext.
+
+    Each block may reference the previous 64 KB of plaintext; the bootloader
+    reads that history back from flash while decompressing.
+    """
+    import lz4.block
+
+    out = bytearray()
+    for off in range(0, len(fw_data), LZ4_BLOCK_SIZE):
+        chunk = fw_data[off:off + LZ4_BLOCK_SIZE]
+        history = fw_data[max(0, off - LZ4_HISTORY):off]
+        block = lz4.block.compress(chunk, mode='high_compression', compression=12,
+                                   store_size=False, dict=history)
+        out += struct.pack('<I', len(block)) + block
+    return bytes(out)
+
+def chacha20_encrypt(aes_key, data):
+    """ChaCha20 with a key derived from the AES key.
+
+    The 16-byte IV field holds the 12-byte nonce and the initial block
+    counter (little-endian, 0). No PKCS7 padding: only zeros up to the
+    4-byte alignment of the footer.
+    """
+    data += b'\0' * (-len(data) % 4)
+    key = hashlib.sha256(CHACHA20_KEY_LABEL + aes_key).digest()
+    nonce = os.urandom(12)
+    cipher = ChaCha20.new(key=key, nonce=nonce)
+    return nonce + struct.pack('<I', 0), cipher.encrypt(data)
+
+def aes_ctr_encrypt(aes_key, data):
+    """AES-128-CTR; the IV field is the first counter block (128-bit big-endian).
+
+    No PKCS7 padding: only zeros up to the 4-byte alignment of the footer.
+    """
+    data += b'\0' * (-len(data) % 4)
+    iv = os.urandom(16)
+    cipher = AES.new(aes_key, AES.MODE_CTR, nonce=b'', initial_value=iv)
+    return iv, cipher.encrypt(data)
+
+def aead_encrypt(aes_key, header, data):
+    """ChaCha20-Poly1305 (RFC 8439) with the header as associated data.
+
+    The IV field holds the 12-byte nonce and block counter 1, where RFC 8439
+    starts the data (block 0 makes the Poly1305 key). Returns the IV, the
+    ciphertext and the 16-byte tag.
+    """
+    key = hashlib.sha256(CHACHA20_KEY_LABEL + aes_key).digest()
+    nonce = os.urandom(12)
+    cipher = ChaCha20_Poly1305.new(key=key, nonce=nonce)
+    cipher.update(header)
+    encrypted_data, tag = cipher.encrypt_and_digest(data)
+    return nonce + struct.pack('<I', 1), encrypted_data, tag
+
+def chunk_digests(encrypted_data):
+    """SHA-256 of every CHUNK_SIZE bytes of ciphertext (the last may be short)."""
+    return b''.join(hashlib.sha256(encrypted_data[off:off + CHUNK_SIZE]).digest()
+                    for off in range(0, len(encrypted_data), CHUNK_SIZE))
+
+def build_footer(sk, digest, payload_size, version=FIRMWARE_VERSION):
+    """fw_footer_t: version, payload size, ECDSA signature (r + s), magic."""
+    signature = sk.sign_digest(digest)
+    return struct.pack('<II', version, payload_size) + signature + struct.pack('<I', FOOTER_MAGIC)
+
+def generate_xip(input_file, slot_addr, version=FIRMWARE_VERSION):
+    """Sign a plaintext image linked to run in place from slot_addr (BL_XIP_AB).
+
+    Layout: [ image, zero-padded to 4 bytes ][ fw_footer_t ]. There is no
+    header or IV: the vector table must stay at the slot start. The
+    signature covers the padded image and the footer's version and size
+    words, as the bootloader picks the slot to run by version.
+    """
+    with open(KEY_FILE, "rb") as f:
+        sk = SigningKey.from_pem(f.read())
+
+    print(f"Reading firmware: {input_file}")
+    with open(input_file, "rb") as f:
+        fw_data = f.read()
+    fw_data += b'\0' * (-len(fw_data) % 4)
+
+    # An image linked for the other slot would crash; the bootloader rejects it too
+    reset_handler = struct.unpack_from('<I', fw_data, 4)[0]
+    if not slot_addr < reset_handler < slot_addr + len(fw_data):
+        print(f"Error: reset handler 0x{reset_handler:08X} is outside the image at "
+              f"0x{slot_addr:08X}. Link the application for this slot.")
+        return
+    if len(fw_data) + 76 > SLOT_SIZE:
+        print(f"Error: image and footer do not fit the {SLOT_SIZE // 1024} KB slot.")
+        return
+
+    print("Signing image...")
+    fields = struct.pack('<II', version, len(fw_data))
+    footer = build_footer(sk, hashlib.sha256(fw_data + fields).digest(), len(fw_data), version)
+
+    output_file = XIP_OUTPUT_FILE.format(slot_addr)
+    with open(output_file, "wb") as f:
+        f.write(fw_data + footer)
+
+    print(f"\n[SUCCESS] In-place image for 0x{slot_addr:08X} created: {output_file}")
+    print(f"Total File Size: {len(fw_data) + len(footer)} bytes")
+
+def generate_update(input_file, compress=False, cipher_mode="cbc", chunked=False, overwrite=False,
+                    version=FIRMWARE_VERSION):
     if not os.path.exists(input_file):
         print(f"Error: Input file '{input_file}' not found.")
         return
@@ -34,35 +152,86 @@ def generate_update(input_file):
     print(f"Reading firmware: {input_file}")
     with open(input_file, "rb") as f:
         fw_data = f.read()
+    if len(fw_data) < 8:
+        print("Error: the image is too short to hold a vector table.")
+        return
     
-    # 3. Encrypt Firmware (AES-CBC)
-    print("Encrypting firmware...")
-    iv = os.urandom(16)
-    cipher = AES.new(aes_key, AES.MODE_CBC, iv)
-    padded_data = pad(fw_data, AES.block_size)
-    encrypted_data = cipher.encrypt(padded_data)
+    flags = FLAG_OVERWRITE if overwrite else 0
+    plain_data = fw_data
+    if compress:
+        plain_data = lz4_compress(fw_data)
+        flags |= FLAG_LZ4
+        print(f"  LZ4: {len(fw_data)} -> {len(plain_data)} bytes "
+              f"({100.0 * len(plain_data) / len(fw_data):.1f}%)")
+
+    # 3. Encrypt Firmware (AES-CBC, AES-CTR, ChaCha20 or ChaCha20-Poly1305)
+    #    The IV field is 16 bytes in every mode, so the layout is the same
+    tag = b''
+    if cipher_mode == "aead":
+        # The header is authenticated data, so it is built before encrypting
+        print("Encrypting firmware (ChaCha20-Poly1305)...")
+        flags |= FLAG_CHACHA20 | FLAG_AEAD
+        plain_data += b'\0' * (-len(plain_data) % 4)
+        footer_offset = HEADER_SIZE + 16 + len(plain_data) + AEAD_TAG_SIZE + AEAD_DIGEST_SIZE
+        header = struct.pack('<IIII', HEADER_MAGIC, footer_offset, flags, len(fw_data))
+        iv, encrypted_data, tag = aead_encrypt(aes_key, header, plain_data)
+        # The tag key derives from the device key, so the signed manifest also
+        # carries the SHA-256 of the ciphertext
+        tag += hashlib.sha256(encrypted_data).digest()
+    elif cipher_mode == "ctr":
+        print("Encrypting firmware (AES-CTR)...")
+        flags |= FLAG_AES_CTR
+        iv, encrypted_data = aes_ctr_encrypt(aes_key, plain_data)
+    elif cipher_mode == "chacha20":
+        print("Encrypting firmware (ChaCha20)...")
+        flags |= FLAG_CHACHA20
+        iv, encrypted_data = chacha20_encrypt(aes_key, plain_data)
+    else:
+        padded_data = pad(plain_data, AES.block_size)
+        print("Encrypting firmware...")
+        iv = os.urandom(16)
+        cipher = AES.new(aes_key, AES.MODE_CBC, iv)
+        encrypted_data = cipher.encrypt(padded_data)
     
-    # Payload = IV + Encrypted Data
-    payload = iv + encrypted_data
+    # 4. Build Header (MATCHING C STRUCT fw_header_t)
+    #   uint32_t magic;
+    #   uint32_t footer_offset;   -> footer follows the payload directly
+    #   uint32_t flags;
+    #   uint32_t image_size;      -> plaintext size before padding
+    if chunked:
+        flags |= FLAG_CHUNKED
+        tag = chunk_digests(encrypted_data)
+        print(f"  Chunk manifest: {len(tag) // 32} x {CHUNK_SIZE} bytes")
+    footer_offset = HEADER_SIZE + len(iv) + len(encrypted_data) + len(tag)
+    header = struct.pack('<IIII', HEADER_MAGIC, footer_offset, flags, len(fw_data))
+
+    # Payload = Header + IV + Encrypted Data [+ Tag and data digest, or chunk digests] (header is signed too)
+    payload = header + iv + encrypted_data + tag
     payload_size = len(payload)
     print(f"  Encrypted Payload Size: {payload_size} bytes")
 
-    # 4. Sign the Payload
-    print("Signing payload...")
-    h = hashlib.sha256(payload).digest()
-    signature = sk.sign_digest(h)
+    # 5. Sign the Payload, or with AEAD / chunks only the manifest Header + IV + Tag and digest / Digests
+    if tag:
+        print("Signing manifest...")
+        h = hashlib.sha256(header + iv + tag).digest()
+    else:
+        print("Signing payload...")
+        h = hashlib.sha256(payload).digest()
 
-    # 5. Create Footer (MATCHING C STRUCT)
+    # 6. Create Footer (MATCHING C STRUCT)
     # C Struct:
     #   uint32_t version;
     #   uint32_t size;
     #   uint8_t  signature[64];
     #   uint32_t magic;
     
-    footer = struct.pack('<II', FIRMWARE_VERSION, payload_size) + signature + struct.pack('<I', FOOTER_MAGIC)
+    footer = build_footer(sk, h, payload_size, version)
 
-    # 6. Write Output
+    # 7. Write Output
     final_data = payload + footer
+    if len(final_data) > SLOT_SIZE:
+        print(f"Error: the {len(final_data)}-byte package does not fit the {SLOT_SIZE // 1024} KB slot.")
+        return
     with open(OUTPUT_FILE, "wb") as f:
         f.write(final_data)
 
@@ -70,7 +239,35 @@ def generate_update(input_file):
     print(f"Total File Size: {len(final_data)} bytes")
 
 if __name__ == "__main__":
-    if len(sys.argv) < 2:
-        print("Usage: python generate_update.py <application.bin>")
+    parser = argparse.ArgumentParser(description="Encrypt and sign a firmware update package.")
+    parser.add_argument("input", help="application .bin")
+    parser.add_argument("--lz4", action="store_true",
+                        help="LZ4-compress the firmware before encryption (needs 'pip install lz4')")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--chacha20", dest="cipher", action="store_const", const="chacha20",
+                      default="cbc", help="encrypt with ChaCha20 instead of AES-128-CBC")
+    mode.add_argument("--ctr", dest="cipher", action="store_const", const="ctr",
+                      help="encrypt with AES-128-CTR (random access, no padding)")
+    mode.add_argument("--aead", dest="cipher", action="store_const", const="aead",
+                      help="encrypt with ChaCha20-Poly1305 and sign only header, IV, tag and data digest")
+    parser.add_argument("--chunked", action="store_true",
+                        help="sign per-4 KB ciphertext digests so a bad chunk stops the install early")
+    parser.add_argument("--overwrite", action="store_true",
+                        help="install straight over the running image, without a backup to roll back to")
+    parser.add_argument("--xip", metavar="SLOT_ADDR", type=lambda v: int(v, 0),
+                        help="sign an unencrypted image linked to run in place at SLOT_ADDR "
+                             "(bootloader built with BL_XIP_AB)")
+    parser.add_argument("--version", type=lambda v: int(v, 0), default=FIRMWARE_VERSION,
+                        help=f"firmware version in the footer (default 0x{FIRMWARE_VERSION:04X})")
+    args = parser.parse_args()
+    if not 0 <= args.version <= 0xFFFFFFFF:
+        parser.error("--version must fit in 32 bits")
+    if args.chunked and args.cipher == "aead":
+        parser.error("--chunked cannot be combined with --aead (its digest already covers the data)")
+    if args.xip is not None:
+        if args.lz4 or args.chunked or args.overwrite or args.cipher != "cbc":
+            parser.error("--xip images run from flash as they are: no compression or encryption")
+        generate_xip(args.input, args.xip, args.version)
     else:
-        generate_update(sys.argv[1])
\ No newline at end of file
+        generate_update(args.input, compress=args.lz4, cipher_mode=args.cipher, chunked=args.chunked,
+                        overwrite=args.overwrite, version=args.version)